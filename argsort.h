@@ -0,0 +1,118 @@
+#ifndef ARGSORT_H
+#define ARGSORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include "block_sort.h"
+#include "float_sort.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+
+// Argsort: the permutation that sorts the keys, leaving the keys untouched.
+// Arithmetic keys are mapped to unsigned integers with the same order (as in
+// float_sort) and packed with their index into one word, key in the high bits:
+// keys of up to 32 bits with indices below 2^32 fill a single uint64_t, so the
+// integer kernels sort the words unchanged. Wider keys or indices use a
+// (key, index) pair instead. Either way the index breaks ties, so the result
+// is stable whatever kernel sorts the words.
+// Other keys sort an index array through a key comparator: block_sort when
+// stable, the network kernels otherwise.
+namespace cam {
+
+    namespace argsorting {
+
+        template<class K>
+        using ordered_t = std::conditional_t<sizeof(K) <= 4, uint32_t, uint64_t>;
+
+        // Unsigned integer whose unsigned order is the order of k
+        template<class K>
+        ordered_t<K> ordered_key(K k) noexcept {
+            using U = ordered_t<K>;
+            if constexpr (std::is_floating_point_v<K>) {
+                return static_cast<U>(to_ordered_bits(k));
+            } else if constexpr (std::is_signed_v<K>) {
+                constexpr U SIGN = U(1) << (sizeof(K) * 8 - 1);
+                return static_cast<U>(static_cast<std::make_unsigned_t<K>>(k) ^ SIGN);
+            } else {
+                return static_cast<U>(k);
+            }
+        }
+
+        template<class K>
+        inline constexpr bool packable = std::is_arithmetic_v<K> && !std::is_same_v<K, bool> &&
+                                         (!std::is_floating_point_v<K> || std::numeric_limits<K>::is_iec559);
+
+        // Wide form of the packed word: ordered key, then index
+        template<class U, class I>
+        struct KeyIndex {
+            U key;
+            I index;
+            bool operator<(const KeyIndex& o) const { return key < o.key || (key == o.key && index < o.index); }
+        };
+
+        // Sorts words by operator< and writes the index part of each to out
+        template<class W, class Index>
+        void sort_words(Buffer<W>& words, Buffer<size_t>& out, Index index) {
+            Buffer<W> temp(words.size());
+            chunk_sort_auto(words, temp);
+            for (size_t i = 0; i < words.size(); i++) out[i] = static_cast<size_t>(index(words[i]));
+        }
+
+    } // namespace argsorting
+
+    // Indices that sort keys ascending: keys[idx[0]] <= keys[idx[1]] <= ...
+    // Arithmetic keys are always ordered stably (equal keys keep their index order);
+    // floats follow the IEEE total order of float_sort with NaNs split by sign.
+    template<class Vec>
+    Buffer<size_t> argsort(const Vec& keys) {
+        using K = typename Vec::value_type;
+        using namespace argsorting;
+        static_assert(packable<K>, "argsort without a comparator needs arithmetic keys");
+        using U = ordered_t<K>;
+        size_t n = keys.size();
+        Buffer<size_t> idx(n);
+        if (n == 0) return idx;
+
+        if (sizeof(U) == 4 && n - 1 <= std::numeric_limits<uint32_t>::max()) {
+            Buffer<uint64_t> words(n);
+            for (size_t i = 0; i < n; i++) words[i] = (uint64_t(ordered_key(keys[i])) << 32) | i;
+            sort_words(words, idx, [](uint64_t w) { return static_cast<uint32_t>(w); });
+        } else if (n - 1 <= std::numeric_limits<uint32_t>::max()) {
+            Buffer<KeyIndex<U, uint32_t>> words(n);
+            for (size_t i = 0; i < n; i++) words[i] = {ordered_key(keys[i]), static_cast<uint32_t>(i)};
+            sort_words(words, idx, [](const auto& w) { return w.index; });
+        } else {
+            Buffer<KeyIndex<U, uint64_t>> words(n);
+            for (size_t i = 0; i < n; i++) words[i] = {ordered_key(keys[i]), i};
+            sort_words(words, idx, [](const auto& w) { return w.index; });
+        }
+        return idx;
+    }
+
+    // Indices that sort keys by comp. Stable keeps equal keys in index order.
+    template<class Vec, class Compare>
+    Buffer<size_t> argsort(const Vec& keys, Compare comp, bool stable = false) {
+        size_t n = keys.size();
+        Buffer<size_t> idx(n);
+        for (size_t i = 0; i < n; i++) idx[i] = i;
+        auto by_key = [&](size_t a, size_t b) { return comp(keys[a], keys[b]); };
+        if (stable) {
+            block_sort(idx, by_key);
+        } else {
+            Buffer<size_t> temp(n);
+            switch (CHUNK_SIZE) {  // Same dispatch as chunk_sort_auto, with the key comparator
+            case 32:  chunk_sort_fixed<32>(idx, temp, by_key);  break;
+            case 128: chunk_sort_fixed<128>(idx, temp, by_key); break;
+            case 256: chunk_sort_fixed<256>(idx, temp, by_key); break;
+            default:  chunk_sort_fixed<64>(idx, temp, by_key);  break;
+            }
+        }
+        return idx;
+    }
+
+} // namespace cam
+
+#endif // ARGSORT_H
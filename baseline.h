@@ -0,0 +1,158 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Benchmark baselines and regression checks. A baseline file stores the
+// per-iteration times of every benchmark case, one case per line:
+//   <case name>\t<ns> <ns> ...
+// A later run is compared case by case with the Mann-Whitney U test (rank
+// based, so a few noisy iterations do not decide the result). The speedup is
+// the Hodges-Lehmann estimate of the baseline/new time ratio with its
+// confidence interval. A case regresses when its slowdown exceeds the threshold
+// and the test rejects "same distribution" at the given significance level.
+namespace cam::bench {
+
+    struct Case {
+        std::string name;         // Identifies the case across runs, including its parameters
+        std::vector<double> ns;   // Time of every iteration
+    };
+
+    inline constexpr const char* BASELINE_HEADER = "# cam benchmark baseline v1";
+
+    inline void save_baseline(const std::string& path, const std::vector<Case>& cases) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot write baseline " + path);
+        out << BASELINE_HEADER << '\n';
+        out.precision(17);
+        for (const Case& c : cases) {
+            out << c.name << '\t';
+            for (size_t i = 0; i < c.ns.size(); i++) out << (i ? " " : "") << c.ns[i];
+            out << '\n';
+        }
+        if (!out) throw std::runtime_error("Cannot write baseline " + path);
+    }
+
+    inline std::vector<Case> load_baseline(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("Cannot read baseline " + path);
+        std::vector<Case> cases;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos) throw std::runtime_error("Malformed baseline line: " + line);
+            Case c{line.substr(0, tab), {}};
+            std::istringstream values(line.substr(tab + 1));
+            for (double x; values >> x;) c.ns.push_back(x);
+            cases.push_back(std::move(c));
+        }
+        return cases;
+    }
+
+    struct MannWhitney {
+        double u = 0;  // U statistic of the first sample
+        double z = 0;  // Normal approximation, tie corrected
+        double p = 1;  // Two-sided p-value
+    };
+
+    // Mann-Whitney U test of samples a and b (normal approximation, fine from ~8 samples each)
+    inline MannWhitney mann_whitney(const std::vector<double>& a, const std::vector<double>& b) {
+        MannWhitney r;
+        double n1 = double(a.size()), n2 = double(b.size());
+        if (a.empty() || b.empty()) return r;
+
+        // Midranks of the pooled samples; tie groups also feed the variance correction
+        std::vector<std::pair<double, bool>> pooled;
+        for (double x : a) pooled.push_back({x, true});
+        for (double x : b) pooled.push_back({x, false});
+        std::sort(pooled.begin(), pooled.end(), [](const auto& x, const auto& y) { return x.first < y.first; });
+        double rank_a = 0, ties = 0, n = n1 + n2;
+        for (size_t i = 0; i < pooled.size();) {
+            size_t j = i;
+            while (j < pooled.size() && pooled[j].first == pooled[i].first) j++;
+            double t = double(j - i), midrank = (double(i) + double(j) + 1) / 2;
+            for (size_t k = i; k < j; k++) rank_a += pooled[k].second ? midrank : 0;
+            ties += t * t * t - t;
+            i = j;
+        }
+        r.u = rank_a - n1 * (n1 + 1) / 2;
+        double mean = n1 * n2 / 2;
+        double var = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+        if (var <= 0) return r;
+        double diff = std::abs(r.u - mean) - 0.5;  // Continuity correction
+        r.z = (r.u > mean ? 1 : -1) * std::max(0.0, diff) / std::sqrt(var);
+        r.p = std::erfc(std::abs(r.z) / std::sqrt(2.0));
+        return r;
+    }
+
+    // z with P(|Z| > z) = alpha for a standard normal Z (bisection on erfc)
+    inline double two_sided_z(double alpha) {
+        double lo = 0, hi = 40;
+        for (int i = 0; i < 100; i++) {
+            double mid = (lo + hi) / 2;
+            (std::erfc(mid / std::sqrt(2.0)) > alpha ? lo : hi) = mid;
+        }
+        return lo;
+    }
+
+    inline double median(std::vector<double> v) {
+        if (v.empty()) return 0;
+        size_t m = v.size() / 2;
+        std::nth_element(v.begin(), v.begin() + m, v.end());
+        double hi = v[m];
+        if (v.size() % 2) return hi;
+        return (*std::max_element(v.begin(), v.begin() + m) + hi) / 2;
+    }
+
+    struct Comparison {
+        std::string name;
+        double base_median = 0;
+        double new_median = 0;
+        double speedup = 1;     // Baseline / new time (Hodges-Lehmann); below 1 is a slowdown
+        double speedup_lo = 1;  // Confidence interval of the speedup
+        double speedup_hi = 1;
+        double p = 1;
+        bool regressed = false;
+    };
+
+    // Compares the new samples of a case with its baseline. threshold is the
+    // tolerated slowdown (0.05: 5%), alpha the significance level of the test and
+    // of the (1 - alpha) confidence interval.
+    inline Comparison compare(const Case& base, const Case& now, double threshold = 0.05, double alpha = 0.05) {
+        Comparison c;
+        c.name = now.name;
+        c.base_median = median(base.ns);
+        c.new_median = median(now.ns);
+        if (base.ns.empty() || now.ns.empty()) return c;
+        c.p = mann_whitney(base.ns, now.ns).p;
+
+        // Hodges-Lehmann: median of all pairwise log ratios, CI from their order statistics
+        std::vector<double> ratios;
+        ratios.reserve(base.ns.size() * now.ns.size());
+        for (double b : base.ns) {
+            for (double x : now.ns) ratios.push_back(std::log(std::max(b, 1.0) / std::max(x, 1.0)));
+        }
+        std::sort(ratios.begin(), ratios.end());
+        double n1 = double(base.ns.size()), n2 = double(now.ns.size()), m = double(ratios.size());
+        double z = two_sided_z(alpha);
+        double k = std::floor(n1 * n2 / 2 - z * std::sqrt(n1 * n2 * (n1 + n2 + 1) / 12));
+        size_t lo = static_cast<size_t>(std::clamp(k, 0.0, m - 1));
+        size_t hi = static_cast<size_t>(std::clamp(m - 1 - k, 0.0, m - 1));
+        c.speedup = std::exp(median(ratios));
+        c.speedup_lo = std::exp(ratios[lo]);
+        c.speedup_hi = std::exp(ratios[hi]);
+        c.regressed = c.p < alpha && c.speedup < 1 / (1 + threshold);
+        return c;
+    }
+
+} // namespace cam::bench
+
+#endif // BASELINE_H
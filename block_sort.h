@@ -0,0 +1,175 @@
+#ifndef BLOCK_SORT_H
+#define BLOCK_SORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+// Stable low-memory sort: the chunk_sort structure (sorted base chunks, then
+// bottom-up merge passes) with a WikiSort-style block merge that needs only a
+// buffer of about sqrt(n) keys instead of a full-size temp.
+// A merge whose shorter side fits the buffer is an ordinary buffered merge.
+// Otherwise A is cut into buffer-sized blocks that are rolled through B: each
+// A block is dropped into place as soon as the B values before it are known,
+// and the previous A block is merged with the B values between the two. The
+// A blocks are dropped in their original order, which keeps the merge stable.
+// O(n log n) time, O(sqrt n) extra memory.
+namespace cam {
+
+    namespace blocks {
+
+        // Stable merge of [l, m) and [m, r) where [l, m) fits in buf
+        template<class T, class Compare>
+        void merge_front(T* a, ptrdiff_t l, ptrdiff_t m, ptrdiff_t r, T* buf, Compare comp) {
+            if (l == m || m == r) return;
+            T* cache = std::copy(a + l, a + m, buf);
+            T* x = buf;
+            T* y = a + m;
+            T* out = a + l;
+            while (x < cache && y < a + r) {
+                CAM_TRACE_LOAD(x);
+                CAM_TRACE_LOAD(y);
+                bool take_y = comp(*y, *x);
+                *out++ = take_y ? *y : *x;
+                y += take_y;
+                x += !take_y;
+            }
+            std::copy(x, cache, out);  // Whatever is left of y is already in place
+        }
+
+        // Stable merge of [l, m) and [m, r) where [m, r) fits in buf
+        template<class T, class Compare>
+        void merge_back(T* a, ptrdiff_t l, ptrdiff_t m, ptrdiff_t r, T* buf, Compare comp) {
+            if (l == m || m == r) return;
+            T* cache = std::copy(a + m, a + r, buf);
+            T* x = a + m;   // One past the next A key
+            T* y = cache;   // One past the next B key
+            T* out = a + r;
+            while (x > a + l && y > buf) {
+                CAM_TRACE_LOAD(x - 1);
+                CAM_TRACE_LOAD(y - 1);
+                bool take_x = comp(*(y - 1), *(x - 1));  // Ties emit B first from the back
+                *--out = take_x ? *(x - 1) : *(y - 1);
+                x -= take_x;
+                y -= !take_x;
+            }
+            std::copy(buf, y, out - (y - buf));
+        }
+
+        // Stable merge of [l, m) and [m, r) with a buffer of 'cap' keys
+        template<class T, class Compare>
+        void merge(T* a, ptrdiff_t l, ptrdiff_t m, ptrdiff_t r, T* buf, ptrdiff_t cap, Compare comp) {
+            if (l == m || m == r || !comp(a[m], a[m - 1])) return;  // Already in order
+            if (m - l <= cap) { merge_front(a, l, m, r, buf, comp); return; }
+            if (r - m <= cap) { merge_back(a, l, m, r, buf, comp); return; }
+
+            const ptrdiff_t bs = cap;
+            // A is a leading uneven block followed by full blocks; tags[i] is the
+            // original index of the i-th remaining full A block in the array
+            ptrdiff_t first_a = (m - l) % bs;
+            ptrdiff_t a_start = l + first_a, a_end = m;
+            std::deque<ptrdiff_t> tags;
+            for (ptrdiff_t i = 0; i < (a_end - a_start) / bs; i++) tags.push_back(i);
+            ptrdiff_t next_tag = 0;
+
+            ptrdiff_t last_a_start = l, last_a_end = l + first_a;
+            ptrdiff_t last_b_start = l, last_b_end = l;  // Empty
+            ptrdiff_t b_start = m, b_end = std::min(m + bs, r);
+
+            auto min_a = [&] {  // Position of the earliest remaining A block
+                size_t k = std::find(tags.begin(), tags.end(), next_tag) - tags.begin();
+                return std::pair<size_t, ptrdiff_t>{k, a_start + static_cast<ptrdiff_t>(k) * bs};
+            };
+
+            while (true) {
+                auto [k, min_pos] = min_a();
+                if ((last_b_end > last_b_start && !comp(a[last_b_end - 1], a[min_pos])) || b_end == b_start) {
+                    // Drop the minimum A block: B values of the previous block below it go first
+                    ptrdiff_t b_split = std::lower_bound(a + last_b_start, a + last_b_end, a[min_pos], comp) - a;
+                    ptrdiff_t b_remaining = last_b_end - b_split;
+
+                    std::swap_ranges(a + a_start, a + a_start + bs, a + min_pos);
+                    std::swap(tags[0], tags[k]);
+
+                    // The previous A block meets the B values that precede the dropped one
+                    merge_front(a, last_a_start, last_a_end, b_split, buf, comp);
+
+                    std::rotate(a + b_split, a + a_start, a + a_start + bs);
+
+                    last_a_start = a_start - b_remaining;
+                    last_a_end = last_a_start + bs;
+                    last_b_start = last_a_end;
+                    last_b_end = last_a_end + b_remaining;
+
+                    tags.pop_front();
+                    next_tag++;
+                    a_start += bs;
+                    if (a_start == a_end) break;
+                } else if (b_end - b_start < bs) {
+                    // The uneven last B block moves in front of the remaining A blocks
+                    std::rotate(a + a_start, a + b_start, a + b_end);
+                    last_b_start = a_start;
+                    last_b_end = a_start + (b_end - b_start);
+                    a_start += b_end - b_start;
+                    a_end += b_end - b_start;
+                    b_end = b_start;
+                } else {
+                    // Roll the leftmost A block to the back by swapping it with the next B block
+                    std::swap_ranges(a + a_start, a + a_start + bs, a + b_start);
+                    tags.push_back(tags.front());
+                    tags.pop_front();
+                    last_b_start = a_start;
+                    last_b_end = a_start + bs;
+                    a_start += bs;
+                    a_end += bs;
+                    b_start += bs;
+                    b_end = std::min(b_end + bs, r);
+                }
+            }
+            merge_front(a, last_a_start, last_a_end, r, buf, comp);
+        }
+
+    } // namespace blocks
+
+    // Stable merge of v[left..mid] and v[mid+1..right] using a buffer of buf.size() keys
+    template<class Vec, class Buf, class Compare = std::less<>>
+    void block_merge(Vec& v, ptrdiff_t left, ptrdiff_t mid, ptrdiff_t right, Buf& buf, Compare comp = {}) {
+        blocks::merge(v.data(), left, mid + 1, right + 1, buf.data(), static_cast<ptrdiff_t>(buf.size()), comp);
+    }
+
+    // Stable sort of v with about sqrt(n) keys of extra memory, allocated with scratch_options
+    template<class Vec, class Compare = std::less<>>
+    void block_sort(Vec& v, Compare comp = {}, const BufferOptions& scratch_options = {}) {
+        using T = typename Vec::value_type;
+        ptrdiff_t n = static_cast<ptrdiff_t>(v.size());
+        if (n < 2) return;
+        T* a = v.data();
+
+        ptrdiff_t chunk = std::max<ptrdiff_t>(1, CHUNK_SIZE / sizeof(T));
+        CAM_TRACE_PHASE("block: base sort");
+        for (ptrdiff_t i = 0; i < n; i += chunk) {  // Insertion sort keeps the base chunks stable
+            ptrdiff_t end = std::min(i + chunk, n);
+            for (ptrdiff_t j = i + 1; j < end; j++) {
+                T x = a[j];
+                ptrdiff_t k = j;
+                for (; k > i && comp(x, a[k - 1]); k--) a[k] = a[k - 1];
+                a[k] = x;
+            }
+        }
+
+        Buffer<T> buf(static_cast<size_t>(std::ceil(std::sqrt(double(n)))), buffer_allocator<T>(scratch_options));
+        for (ptrdiff_t size = chunk; size < n; size *= 2) {
+            CAM_TRACE_PHASE("block: merge run " + std::to_string(size));
+            for (ptrdiff_t i = 0; i + size < n; i += 2 * size) {
+                blocks::merge(a, i, i + size, std::min(i + 2 * size, n), buf.data(), static_cast<ptrdiff_t>(buf.size()), comp);
+            }
+        }
+    }
+
+} // namespace cam
+
+#endif // BLOCK_SORT_H
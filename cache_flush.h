@@ -0,0 +1,71 @@
+#ifndef CACHE_FLUSH_H
+#define CACHE_FLUSH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "cache_size.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define CAM_HAS_CLFLUSH 1
+#endif
+
+// Cache eviction between timed runs, for cold-cache benchmarks. Copying the
+// input right before a run leaves it hot in cache, which flatters small sizes
+// when real data arrives cold (from the network or disk). evict() first sweeps
+// a buffer twice the size of the last-level cache, writing every line so dirty
+// lines of the previous run are written back. It then flushes the given ranges
+// line by line with clflush where available, because a sweep alone may leave
+// some lines behind under adaptive replacement policies.
+namespace cam {
+
+    enum class CacheMode { warm, cold };
+
+    class CacheFlusher {
+    public:
+        CacheFlusher()
+            : line_(std::max<size_t>(sizeof(uint64_t), CacheDetector::getCacheLineSize())),
+              sweep_(2 * last_level_bytes() / sizeof(uint64_t)) {}
+
+        // Bytes swept per eviction
+        size_t sweep_bytes() const { return sweep_.size() * sizeof(uint64_t); }
+
+        // Evicts every cache level, then each vector's keys from every level
+        template<class... Vecs>
+        void evict(const Vecs&... vecs) {
+            sweep();
+            (flush(vecs.data(), vecs.size() * sizeof(*vecs.data())), ...);
+#ifdef CAM_HAS_CLFLUSH
+            _mm_mfence();
+#endif
+        }
+
+    private:
+        static size_t last_level_bytes() {
+            return size_t(std::max(CacheDetector::getCacheInfo(2).size_kb, CacheDetector::getCacheInfo(3).size_kb)) * 1024;
+        }
+
+        void sweep() {
+            size_t stride = line_ / sizeof(uint64_t);
+            for (size_t i = 0; i < sweep_.size(); i += stride) sweep_[i]++;
+        }
+
+        void flush(const void* p, size_t bytes) {
+#ifdef CAM_HAS_CLFLUSH
+            auto first = reinterpret_cast<uintptr_t>(p) & ~(uintptr_t(line_) - 1);
+            auto last = reinterpret_cast<uintptr_t>(p) + bytes;
+            for (uintptr_t a = first; a < last; a += line_) _mm_clflush(reinterpret_cast<const void*>(a));
+#else
+            (void)p; (void)bytes;  // The sweep is all there is
+#endif
+        }
+
+        size_t line_;
+        std::vector<uint64_t> sweep_;
+    };
+
+} // namespace cam
+
+#endif // CACHE_FLUSH_H
@@ -0,0 +1,164 @@
+#ifndef CACHE_SIM_H
+#define CACHE_SIM_H
+
+// Deterministic cache simulator for the sort kernels.
+// When the project is built with CAM_CACHE_SIM every load and store in the
+// kernels goes through CAM_TRACE_LOAD / CAM_TRACE_STORE, which drive a
+// set-associative LRU model of L1/L2/L3. Miss counts are exact and repeatable,
+// unlike hardware counters, so chunk sizes can be compared without timing noise.
+// In normal builds the hooks compile to nothing.
+
+#ifdef CAM_CACHE_SIM
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cache_size.h"
+
+namespace cam::sim {
+
+    // One set-associative LRU cache level
+    class CacheLevel {
+    public:
+        CacheLevel() = default;
+
+        CacheLevel(const CacheDetector::CacheInfo& info)
+            : ways_(info.ways), sets_(info.sets),
+              tags_(size_t(info.ways) * info.sets, EMPTY),
+              stamps_(size_t(info.ways) * info.sets, 0) {
+            while ((1u << line_shift_) < info.line_size) line_shift_++;
+        }
+
+        // Returns true on hit. On a miss the least recently used way is replaced.
+        bool access(uint64_t addr) {
+            uint64_t line = addr >> line_shift_;
+            uint64_t* tags   = &tags_[(line % sets_) * ways_];
+            uint64_t* stamps = &stamps_[(line % sets_) * ways_];
+            clock_++;
+
+            uint32_t victim = 0;
+            for (uint32_t w = 0; w < ways_; w++) {
+                if (tags[w] == line) {
+                    stamps[w] = clock_;
+                    return true;
+                }
+                if (stamps[w] < stamps[victim]) victim = w;
+            }
+            tags[victim] = line;
+            stamps[victim] = clock_;
+            return false;
+        }
+
+        void clear() {
+            std::fill(tags_.begin(), tags_.end(), EMPTY);
+            std::fill(stamps_.begin(), stamps_.end(), 0);
+            clock_ = 0;
+        }
+
+        uint32_t line_size() const { return 1u << line_shift_; }
+
+    private:
+        static constexpr uint64_t EMPTY = ~uint64_t(0);
+
+        uint32_t ways_ = 1;
+        uint32_t sets_ = 1;
+        uint32_t line_shift_ = 0;
+        uint64_t clock_ = 0;
+        std::vector<uint64_t> tags_;
+        std::vector<uint64_t> stamps_;
+    };
+
+    // Counters collected while a named phase is active
+    struct PhaseStats {
+        std::string name;
+        uint64_t loads = 0;
+        uint64_t stores = 0;
+        uint64_t misses[3] = {0, 0, 0};  // L1, L2, L3 (an L3 miss goes to DRAM)
+    };
+
+    // Non-inclusive L1 -> L2 -> L3 hierarchy with write-allocate stores
+    class Hierarchy {
+    public:
+        Hierarchy() { configure(CacheDetector::getCacheInfo(1),
+                                CacheDetector::getCacheInfo(2),
+                                CacheDetector::getCacheInfo(3)); }
+
+        void configure(const CacheDetector::CacheInfo& l1,
+                       const CacheDetector::CacheInfo& l2,
+                       const CacheDetector::CacheInfo& l3) {
+            info_[0] = l1; info_[1] = l2; info_[2] = l3;
+            for (int i = 0; i < 3; i++) levels_[i] = CacheLevel(info_[i]);
+            reset();
+        }
+
+        const CacheDetector::CacheInfo& info(int level) const { return info_[level]; }
+
+        // Cold caches and no phases
+        void reset() {
+            for (auto& level : levels_) level.clear();
+            phases_.clear();
+            current_ = 0;
+        }
+
+        void enable(bool on) { enabled_ = on; }
+
+        // Switch the phase that subsequent accesses are charged to
+        void phase(const std::string& name) {
+            if (!enabled_) return;
+            for (size_t i = 0; i < phases_.size(); i++) {
+                if (phases_[i].name == name) { current_ = i; return; }
+            }
+            phases_.push_back(PhaseStats{name});
+            current_ = phases_.size() - 1;
+        }
+
+        void load(const void* p, size_t bytes)  { access(p, bytes, false); }
+        void store(const void* p, size_t bytes) { access(p, bytes, true); }
+
+        const std::vector<PhaseStats>& phases() const { return phases_; }
+
+    private:
+        void access(const void* p, size_t bytes, bool is_store) {
+            if (!enabled_) return;
+            if (phases_.empty()) phase("unnamed");
+            PhaseStats& stats = phases_[current_];
+            (is_store ? stats.stores : stats.loads)++;
+
+            // An access that straddles a line boundary touches every line it covers
+            uint64_t line = levels_[0].line_size();
+            uint64_t first = reinterpret_cast<uint64_t>(p) & ~(line - 1);
+            uint64_t last  = (reinterpret_cast<uint64_t>(p) + bytes - 1) & ~(line - 1);
+            for (uint64_t addr = first; addr <= last; addr += line) {
+                for (int l = 0; l < 3; l++) {
+                    if (levels_[l].access(addr)) break;
+                    stats.misses[l]++;
+                }
+            }
+        }
+
+        CacheDetector::CacheInfo info_[3];
+        CacheLevel levels_[3];
+        std::vector<PhaseStats> phases_;
+        size_t current_ = 0;
+        bool enabled_ = false;
+    };
+
+    // Process-wide simulator the trace hooks report to
+    inline Hierarchy& tracer() {
+        static Hierarchy instance;
+        return instance;
+    }
+
+} // namespace cam::sim
+
+#define CAM_TRACE_LOAD(p)     ::cam::sim::tracer().load((p), sizeof(*(p)))
+#define CAM_TRACE_STORE(p)    ::cam::sim::tracer().store((p), sizeof(*(p)))
+#define CAM_TRACE_PHASE(name) ::cam::sim::tracer().phase(name)
+#else
+#define CAM_TRACE_LOAD(p)     ((void)0)
+#define CAM_TRACE_STORE(p)    ((void)0)
+#define CAM_TRACE_PHASE(name) ((void)0)
+#endif
+
+#endif // CACHE_SIM_H
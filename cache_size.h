@@ -6,7 +6,7 @@
 
 #ifdef _WIN32
 #include <intrin.h>
-#else
+#elif defined(__x86_64__) || defined(__i386__)
 #include <cpuid.h>
 #endif
 
@@ -21,21 +21,24 @@ namespace CacheDetector {
         ebx = regs[1];
         ecx = regs[2];
         edx = regs[3];
-#else
+#elif defined(__x86_64__) || defined(__i386__)
         eax = func;
         ecx = subfunc;
         __cpuid_count(func, subfunc, eax, ebx, ecx, edx);
+#else
+        (void)func; (void)subfunc;
+        eax = ebx = ecx = edx = 0;  // No CPUID: callers fall back to their defaults
 #endif
     }
 
-    // Get L1 cache size in KB
-    inline uint32_t getL1CacheSize() {
+    // Get L1 cache size in KB (verbose dumps the raw CPUID registers)
+    inline uint32_t getL1CacheSize(bool verbose = false) {
         uint32_t size = 0;
         uint32_t eax, ebx, ecx, edx;
 
         // First check CPUID leaf 2 (older method)
         getCpuid(2, 0, eax, ebx, ecx, edx);
-        std::cout << "CPUID Leaf 2: " << std::hex << "eax=" << eax << " ebx=" << ebx 
+        if (verbose) std::cout << "CPUID Leaf 2: " << std::hex << "eax=" << eax << " ebx=" << ebx 
                   << " ecx=" << ecx << " edx=" << edx << std::dec << "\n";
 
         uint8_t* descriptors = reinterpret_cast<uint8_t*>(&eax);
@@ -62,7 +65,7 @@ namespace CacheDetector {
         if (size == 0) {
             for (uint32_t i = 0; i < 4; i++) {
                 getCpuid(0x4, i, eax, ebx, ecx, edx);  // Use sub-leaf index i
-                std::cout << "CPUID Leaf 4." << i << ": " << std::hex << "eax=" << eax 
+                if (verbose) std::cout << "CPUID Leaf 4." << i << ": " << std::hex << "eax=" << eax 
                           << " ebx=" << ebx << " ecx=" << ecx << " edx=" << edx << std::dec << "\n";
 
                 uint32_t cacheType = (eax & 0x1F);         // Cache type (0 = null, 1 = data, 3 = unified)
@@ -74,7 +77,7 @@ namespace CacheDetector {
                     uint32_t line = (ebx & 0xFFF) + 1;          // Cache line size in bytes
                     uint32_t sets = ecx + 1;                    // Number of sets
                     size = (ways * line * sets) / 1024;        // Total size in KB
-                    std::cout << "Detected L1 cache size: " << size << " KB\n";
+                    if (verbose) std::cout << "Detected L1 cache size: " << size << " KB\n";
                     break;
                 }
             }
@@ -89,6 +92,50 @@ namespace CacheDetector {
         return size;
     }
 
+    // Geometry of one data/unified cache level as reported by CPUID leaf 4
+    struct CacheInfo {
+        uint32_t size_kb;    // Total size in KB
+        uint32_t ways;       // Ways of associativity
+        uint32_t line_size;  // Cache line size in bytes
+        uint32_t sets;       // Number of sets
+    };
+
+    // Typical desktop geometry, used when CPUID does not describe the level
+    inline CacheInfo defaultCacheInfo(uint32_t level) {
+        switch (level) {
+        case 1:  return {32, 8, 64, 64};
+        case 2:  return {1024, 16, 64, 1024};
+        default: return {32768, 16, 64, 32768};
+        }
+    }
+
+    // Get the geometry of cache level 1..3 without printing anything
+    inline CacheInfo getCacheInfo(uint32_t level) {
+        uint32_t eax, ebx, ecx, edx;
+        for (uint32_t i = 0; i < 16; i++) {
+            getCpuid(0x4, i, eax, ebx, ecx, edx);
+
+            uint32_t cacheType = (eax & 0x1F);
+            if (cacheType == 0) break;
+            uint32_t cacheLevel = ((eax >> 5) & 0x7);
+
+            if ((cacheType == 1 || cacheType == 3) && cacheLevel == level) {
+                CacheInfo info;
+                info.ways      = ((ebx >> 22) & 0x3FF) + 1;
+                info.line_size = (ebx & 0xFFF) + 1;
+                info.sets      = ecx + 1;
+                info.size_kb   = (info.ways * info.line_size * info.sets) / 1024;
+                return info;
+            }
+        }
+        return defaultCacheInfo(level);
+    }
+
+    // Line size of the L1 data cache in bytes
+    inline uint32_t getCacheLineSize() {
+        return getCacheInfo(1).line_size;
+    }
+
     // Static constant for L1 cache size in KB
     static const uint32_t CHUNK_SIZE = getL1CacheSize();
 
@@ -0,0 +1,291 @@
+#ifndef CHUNK_SORT_H
+#define CHUNK_SORT_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include "cache_size.h"
+#include "cache_sim.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define CAM_HAS_STREAM 1
+#endif
+
+// Software prefetch hint; rw is 0 for a read stream, 1 for a write stream
+#if defined(__GNUC__) || defined(__clang__)
+#define CAM_PREFETCH(p, rw) __builtin_prefetch((p), (rw))
+#else
+#define CAM_PREFETCH(p, rw) ((void)(p))
+#endif
+
+namespace cam {
+
+inline size_t CHUNK_SIZE = 64; // using one cache line  as chunk size write using CacheDetector::CHUNK_SIZE; for L1 cache size
+
+// Kernel used by the merge passes above the base chunks
+enum class MergeKernel {
+    gap,        // In place, no buffer
+    branchless  // Ping-pongs through temp, no data-dependent branches
+};
+inline MergeKernel MERGE_KERNEL = MergeKernel::gap;
+
+// How far ahead (in bytes) the merge kernels prefetch their input and output
+// streams; 0 leaves it to the hardware prefetcher
+inline size_t PREFETCH_DISTANCE = 0;
+
+// Merge passes whose output runs exceed this many bytes (by default the detected
+// last-level cache) write with non-temporal stores: the output is not read again
+// until the next pass, so caching it only evicts the inputs
+inline size_t STREAM_THRESHOLD = size_t(CacheDetector::getCacheInfo(3).size_kb) * 1024;
+
+// Optimized gap-based in-place merge
+inline ptrdiff_t nextGap(ptrdiff_t gap) {
+    if (gap <= 1) return 0;
+    return (gap + 1) / 2;
+}
+
+// The kernels take any contiguous vector-like buffer (std::vector with any
+// allocator) of integer-like keys, so placement-aware buffers can be sorted
+// without copying.
+// Indices are 64-bit (ptrdiff_t, inclusive bounds) so arrays beyond 2^31 elements work.
+// The gap passes span all of [left, right], so mid only names the split of the two runs.
+template<class Vec, class Compare = std::less<>>
+void inPlaceMerge(Vec& v, ptrdiff_t left, [[maybe_unused]] ptrdiff_t mid, ptrdiff_t right, Compare comp = {}) {
+    auto* a = v.data();
+    const ptrdiff_t ahead = PREFETCH_DISTANCE / sizeof(*a);
+    // The prefetch choice is a template constant so the plain loop stays as tight as before
+    auto pass = [&](ptrdiff_t gap, auto prefetch) {
+        // Comparing against a hoisted bound leaves a single induction variable in the loop
+        auto* lo = a + left;
+        auto* hi = a + left + gap;
+        auto* end = a + right + 1;
+        for (; hi < end; ++lo, ++hi) {
+            if constexpr (decltype(prefetch)::value) {
+                CAM_PREFETCH(lo + ahead, 1);
+                CAM_PREFETCH(hi + ahead, 1);
+            }
+            CAM_TRACE_LOAD(lo);
+            CAM_TRACE_LOAD(hi);
+            if (comp(*hi, *lo)) {
+                std::swap(*lo, *hi);
+                CAM_TRACE_STORE(lo);
+                CAM_TRACE_STORE(hi);
+            }
+        }
+    };
+    for (ptrdiff_t gap = nextGap(right - left + 1); gap > 0; gap = nextGap(gap)) {
+        if (ahead) pass(gap, std::true_type{});
+        else       pass(gap, std::false_type{});
+    }
+}
+
+// Stable merge of the sorted ranges a[0, na) and b[0, nb) into out, both non-empty.
+// Each step selects the smaller head and advances both cursors by the comparison
+// result, which compiles to conditional moves instead of a 50% mispredicted branch.
+// The range with the larger last key is a sentinel for the other: the loop runs
+// until the other range is exhausted and never reads past the sentinel range, so
+// it checks one bound per step, and only once per unrolled block.
+template<class T, class Compare = std::less<>>
+void branchlessMerge(const T* a, ptrdiff_t na, const T* b, ptrdiff_t nb, T* out, Compare comp = {}) {
+    constexpr ptrdiff_t UNROLL = 4;
+    const ptrdiff_t ahead = PREFETCH_DISTANCE / sizeof(T);
+    ptrdiff_t i = 0, j = 0;
+    auto step = [&] {
+        CAM_TRACE_LOAD(a + i);
+        CAM_TRACE_LOAD(b + j);
+        const T x = a[i];
+        const T y = b[j];
+        bool take_b = comp(y, x);  // Ties take a, which keeps the merge stable
+        *out = take_b ? y : x;
+        CAM_TRACE_STORE(out);
+        ++out;
+        j += take_b;
+        i += !take_b;
+    };
+    // Once per block: the two inputs advance at data-dependent rates, so both are hinted
+    auto block = [&] {
+        if (ahead) {
+            CAM_PREFETCH(a + i + ahead, 0);
+            CAM_PREFETCH(b + j + ahead, 0);
+            CAM_PREFETCH(out + ahead, 1);
+        }
+        step(); step(); step(); step();
+    };
+
+    if (!comp(b[nb - 1], a[na - 1])) {
+        // b's last key is >= every key of a, so b outlasts a
+        while (i + UNROLL <= na) block();
+        while (i < na) step();
+    } else {
+        while (j + UNROLL <= nb) block();
+        while (j < nb) step();
+    }
+    out = std::copy(a + i, a + na, out);
+    std::copy(b + j, b + nb, out);
+}
+
+// Writes one 64-byte line with non-temporal stores; dst is 64-byte aligned
+inline void streamLine(void* dst, const void* src) {
+#if defined(__AVX__)
+    auto* d = static_cast<__m256i*>(dst);
+    auto* s = static_cast<const __m256i*>(src);
+    _mm256_stream_si256(d, _mm256_load_si256(s));
+    _mm256_stream_si256(d + 1, _mm256_load_si256(s + 1));
+#elif defined(CAM_HAS_STREAM)
+    auto* d = static_cast<__m128i*>(dst);
+    auto* s = static_cast<const __m128i*>(src);
+    for (int k = 0; k < 4; k++) _mm_stream_si128(d + k, _mm_load_si128(s + k));
+#else
+    std::memcpy(dst, src, 64);
+#endif
+}
+
+// Orders the preceding streaming stores before any later load or store
+inline void streamFence() {
+#ifdef CAM_HAS_STREAM
+    _mm_sfence();
+#endif
+}
+
+// branchlessMerge with a streaming output path: keys are merged a cache line at a
+// time into an aligned staging line that is then written with non-temporal stores,
+// so the output costs no read-for-ownership and does not pollute the caches.
+// Keys whose size does not divide a line use branchlessMerge.
+template<class T, class Compare = std::less<>>
+void streamingMerge(const T* a, ptrdiff_t na, const T* b, ptrdiff_t nb, T* out, Compare comp = {}) {
+    constexpr ptrdiff_t LINE = 64 / sizeof(T);
+    if constexpr (64 % sizeof(T) != 0 || !std::is_trivially_copyable_v<T>) {
+        branchlessMerge(a, na, b, nb, out, comp);
+    } else {
+        alignas(64) T line[LINE];
+        ptrdiff_t i = 0, j = 0;
+        auto pick = [&] {
+            CAM_TRACE_LOAD(a + i);
+            CAM_TRACE_LOAD(b + j);
+            const T x = a[i];
+            const T y = b[j];
+            bool take_b = comp(y, x);
+            j += take_b;
+            i += !take_b;
+            return take_b ? y : x;
+        };
+
+        // Ordinary stores up to the first line boundary of the output
+        while (reinterpret_cast<uintptr_t>(out) % 64 != 0 && i < na && j < nb) *out++ = pick();
+
+        while (i < na && j < nb) {
+            ptrdiff_t k = 0;
+            if (i + LINE <= na && j + LINE <= nb) {
+                for (; k < LINE; k++) line[k] = pick();  // Neither input can run out within a line
+            } else {
+                for (; k < LINE && i < na && j < nb; k++) line[k] = pick();
+            }
+            if (k == LINE) streamLine(out, line);
+            else           std::copy(line, line + k, out);
+            out += k;
+        }
+
+        // One input is exhausted: stream the other one's rest
+        const T* rest = i < na ? a + i : b + j;
+        ptrdiff_t left = i < na ? na - i : nb - j;
+        while (reinterpret_cast<uintptr_t>(out) % 64 != 0 && left > 0) { *out++ = *rest++; left--; }
+        for (; left >= LINE; left -= LINE, rest += LINE, out += LINE) {
+            std::memcpy(line, rest, 64);
+            streamLine(out, line);
+        }
+        std::copy(rest, rest + left, out);
+        streamFence();
+    }
+}
+
+// One in-place merge level of v[first, n): merges each pair of adjacent runs of length size
+template<class Vec, class Compare = std::less<>>
+void merge_level(Vec& v, ptrdiff_t first, ptrdiff_t n, ptrdiff_t size, Compare comp = {}) {
+    for (ptrdiff_t i = first; i < n; i += 2 * size) {
+        ptrdiff_t mid = std::min(i + size - 1, n - 1);
+        ptrdiff_t right_end = std::min(i + 2 * size - 1, n - 1);
+        if (mid < right_end) {
+            inPlaceMerge(v, i, mid, right_end, comp);
+        }
+    }
+}
+
+// One branchless merge level: merges the runs of src[first, n) pairwise into dst.
+// Streams the output when the merged runs exceed STREAM_THRESHOLD bytes.
+template<class T, class Compare = std::less<>>
+void merge_level(const T* src, T* dst, ptrdiff_t first, ptrdiff_t n, ptrdiff_t size, Compare comp = {}) {
+    bool stream = STREAM_THRESHOLD && size_t(2 * size) * sizeof(T) > STREAM_THRESHOLD;
+    for (ptrdiff_t i = first; i < n; i += 2 * size) {
+        ptrdiff_t mid = std::min(i + size, n);
+        ptrdiff_t right_end = std::min(i + 2 * size, n);
+        if (mid >= right_end)  std::copy(src + i, src + mid, dst + i);
+        else if (stream)       streamingMerge(src + i, mid - i, src + mid, right_end - mid, dst + i, comp);
+        else                   branchlessMerge(src + i, mid - i, src + mid, right_end - mid, dst + i, comp);
+    }
+}
+
+// Runs the merge passes of v[first..last] whose sorted runs have length 'run'.
+// The branchless kernel ping-pongs between v and temp (indexed like v) and needs
+// temp.size() > last; otherwise the in-place gap merge is used.
+template<class Vec, class Compare = std::less<>>
+void merge_passes(Vec& v, ptrdiff_t first, ptrdiff_t last, ptrdiff_t run, Vec& temp, Compare comp = {}) {
+    ptrdiff_t n = last + 1;
+    if (MERGE_KERNEL == MergeKernel::gap || static_cast<ptrdiff_t>(temp.size()) < n) {
+        for (ptrdiff_t size = run; size < n - first; size *= 2) {
+            CAM_TRACE_PHASE("chunk: merge run " + std::to_string(size));
+            merge_level(v, first, n, size, comp);
+        }
+        return;
+    }
+
+    auto* src = v.data();
+    auto* dst = temp.data();
+    for (ptrdiff_t size = run; size < n - first; size *= 2) {
+        CAM_TRACE_PHASE("chunk: merge run " + std::to_string(size));
+        merge_level(src, dst, first, n, size, comp);
+        std::swap(src, dst);
+    }
+    if (src != v.data()) std::copy(src + first, src + n, v.data() + first);
+}
+
+// Optimized merge sort with minimal temporary space
+template<class Vec>
+void merge_sort(Vec& v, ptrdiff_t left, ptrdiff_t right, Vec& temp) {
+    if (left >= right) return;
+
+    ptrdiff_t mid = left + (right - left) / 2;
+    merge_sort(v, left, mid, temp);
+    merge_sort(v, mid + 1, right, temp);
+    inPlaceMerge(v, left, mid, right);
+}
+
+// Optimized chunk sort of v[first..last] using merge sort throughout
+template<class Vec>
+void chunk_sort(Vec& v, ptrdiff_t first, ptrdiff_t last, Vec& temp) {
+    ptrdiff_t n = last + 1;
+    ptrdiff_t chunk_size = std::max<ptrdiff_t>(1, CHUNK_SIZE / sizeof(typename Vec::value_type)); // 16 ints = 64 bytes
+
+    CAM_TRACE_PHASE("chunk: base sort");
+    for (ptrdiff_t i = first; i < n; i += chunk_size) {
+        ptrdiff_t end = std::min(i + chunk_size - 1, n - 1);
+        merge_sort(v, i, end, temp);
+    }
+
+    merge_passes(v, first, last, chunk_size, temp);
+}
+
+// Optimized chunk sort using merge sort throughout
+template<class Vec>
+void chunk_sort(Vec& v, Vec& temp) {
+    chunk_sort(v, 0, static_cast<ptrdiff_t>(v.size()) - 1, temp);
+}
+
+} // namespace cam
+
+#endif // CHUNK_SORT_H
@@ -0,0 +1,159 @@
+#ifndef COUNTING_SORT_H
+#define COUNTING_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "cache_size.h"
+#include "sample_sort.h"
+#include "static_sort.h"
+
+// Counting-sort fast path for integer keys with a small range. One min/max
+// scan (lane-wise, so it vectorizes; split over threads for large inputs)
+// measures the range; when its counters fit in L2 the keys are histogrammed in
+// one sequential read pass and rewritten in one sequential write pass: O(n)
+// instead of log n merge passes. Otherwise the keys go to chunk_sort_auto.
+namespace cam {
+
+    // Counter bytes that must fit for the counting path (one uint32_t per key value)
+    inline size_t COUNTING_MAX_BYTES = size_t(CacheDetector::getCacheInfo(2).size_kb) * 1024;
+
+    template<class T>
+    struct KeyRange {
+        T min;
+        T max;
+        // Number of distinct values in [min, max] minus one (no overflow for any T)
+        uint64_t span() const { return static_cast<uint64_t>(max) - static_cast<uint64_t>(min); }
+    };
+
+    namespace counting {
+
+        inline constexpr size_t MIN_PARALLEL = 1 << 18;  // Keys per thread worth a thread
+
+        // Min and max of a[0..n), n > 0, with independent lanes the compiler vectorizes
+        template<class T>
+        KeyRange<T> scan(const T* a, size_t n) {
+            constexpr size_t LANES = std::max<size_t>(1, 32 / sizeof(T));
+            T lo[LANES], hi[LANES];
+            for (size_t u = 0; u < LANES; u++) lo[u] = hi[u] = a[0];
+            size_t i = 0;
+            for (; i + LANES <= n; i += LANES) {
+                for (size_t u = 0; u < LANES; u++) {
+                    lo[u] = a[i + u] < lo[u] ? a[i + u] : lo[u];
+                    hi[u] = hi[u] < a[i + u] ? a[i + u] : hi[u];
+                }
+            }
+            for (; i < n; i++) {
+                lo[0] = std::min(lo[0], a[i]);
+                hi[0] = std::max(hi[0], a[i]);
+            }
+            KeyRange<T> r{lo[0], hi[0]};
+            for (size_t u = 1; u < LANES; u++) {
+                r.min = std::min(r.min, lo[u]);
+                r.max = std::max(r.max, hi[u]);
+            }
+            return r;
+        }
+
+        inline unsigned threads_for(size_t n, unsigned threads) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            return static_cast<unsigned>(std::clamp<size_t>(n / MIN_PARALLEL, 1, threads));
+        }
+
+    } // namespace counting
+
+    // Smallest and largest key of v (v not empty); threads == 0 uses every hardware thread
+    template<class Vec>
+    auto key_range(const Vec& v, unsigned threads = 0) {
+        using T = typename Vec::value_type;
+        size_t n = v.size();
+        threads = counting::threads_for(n, threads);
+        std::vector<KeyRange<T>> parts(threads);
+        samplesort::parallel(threads, [&](unsigned t) {
+            size_t first = n * t / threads, last = n * (t + 1) / threads;
+            parts[t] = counting::scan(v.data() + first, last - first);
+        });
+        KeyRange<T> r = parts[0];
+        for (const auto& p : parts) {
+            r.min = std::min(r.min, p.min);
+            r.max = std::max(r.max, p.max);
+        }
+        return r;
+    }
+
+    // True when counting_sort pays off: the counters fit in L2 and there are
+    // at most about two counters per key, so the counter scan stays O(n)
+    template<class T>
+    bool counting_applies(const KeyRange<T>& r, size_t n) {
+        uint64_t span = r.span();
+        return span < COUNTING_MAX_BYTES / sizeof(uint32_t) && span <= 2 * uint64_t(n);
+    }
+
+    // Counting sort of v given its key range (see counting_applies)
+    template<class Vec, class T = typename Vec::value_type>
+    void counting_sort(Vec& v, const KeyRange<T>& range, unsigned threads = 0) {
+        static_assert(std::is_integral_v<T>, "counting_sort needs integer keys");
+        size_t n = v.size();
+        if (n < 2) return;
+        size_t values = static_cast<size_t>(range.span()) + 1;
+        threads = counting::threads_for(n, threads);
+        // uint32_t counters keep the histograms small; blocks stay below 2^32 keys each
+        size_t max_block = std::numeric_limits<uint32_t>::max();
+        threads = std::max<unsigned>(threads, static_cast<unsigned>((n + max_block - 1) / max_block));
+
+        // 1. Histograms of every thread's block
+        std::vector<std::vector<uint32_t>> counts(threads, std::vector<uint32_t>(values));
+        T* a = v.data();
+        const uint64_t base = static_cast<uint64_t>(range.min);
+        samplesort::parallel(threads, [&](unsigned t) {
+            size_t first = n * t / threads, last = n * (t + 1) / threads;
+            uint32_t* c = counts[t].data();
+            for (size_t i = first; i < last; i++) c[static_cast<uint64_t>(a[i]) - base]++;
+        });
+
+        // Start of every key value in the output
+        std::vector<size_t> start(values + 1);
+        size_t offset = 0;
+        for (size_t k = 0; k < values; k++) {
+            start[k] = offset;
+            for (unsigned t = 0; t < threads; t++) offset += counts[t][k];
+        }
+        start[values] = n;
+
+        // 2. Every thread rewrites its share of the output positions
+        samplesort::parallel(threads, [&](unsigned t) {
+            size_t first = n * t / threads, last = n * (t + 1) / threads;
+            size_t k = std::upper_bound(start.begin(), start.end(), first) - start.begin() - 1;
+            for (size_t pos = first; pos < last; k++) {
+                size_t end = std::min(start[k + 1], last);
+                std::fill(a + pos, a + end, static_cast<T>(base + k));
+                pos = end;
+            }
+        });
+    }
+
+    // Sorts v with the counting fast path when the key range allows, chunk_sort_auto otherwise.
+    // Returns true when the counting path was taken.
+    template<class Vec>
+    bool range_sort(Vec& v, Vec& temp, unsigned threads = 0) {
+        using T = typename Vec::value_type;
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            if (v.size() >= 2) {
+                KeyRange<T> range = key_range(v, threads);
+                if (counting_applies(range, v.size())) {
+                    counting_sort(v, range, threads);
+                    return true;
+                }
+            }
+        }
+        chunk_sort_auto(v, temp);
+        return false;
+    }
+
+} // namespace cam
+
+#endif // COUNTING_SORT_H
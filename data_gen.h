@@ -0,0 +1,219 @@
+#ifndef DATA_GEN_H
+#define DATA_GEN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "sample_sort.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Seeded, parallel benchmark input generator. Keys come from xoshiro256++
+// run as four independent lanes in struct-of-arrays form, so the compiler
+// vectorizes a step over all lanes. The array is cut into fixed blocks and
+// block b draws from a stream seeded by splitmix64(seed, b) alone, so the
+// keys depend only on (seed, distribution, n, max_key): the same on every
+// machine and for any thread count, and any [first, last) slice can be
+// generated on its own (e.g. streamed to a file). Uniform keys use Lemire's
+// multiply-shift mapping (bias below range / 2^64) instead of the
+// implementation-defined std::uniform_int_distribution.
+namespace cam {
+
+    enum class Distribution { uniform, sorted, reversed, nearly_sorted, few_unique, organ_pipe, equal };
+
+    inline constexpr uint64_t DEFAULT_SEED = 0x5EED;
+
+    inline const char* distribution_name(Distribution d) {
+        switch (d) {
+        case Distribution::uniform:       return "uniform";
+        case Distribution::sorted:        return "sorted";
+        case Distribution::reversed:      return "reversed";
+        case Distribution::nearly_sorted: return "nearly-sorted";
+        case Distribution::few_unique:    return "few-unique";
+        case Distribution::organ_pipe:    return "organ-pipe";
+        default:                          return "equal";
+        }
+    }
+
+    // Parses a name printed by distribution_name; false if unknown
+    inline bool parse_distribution(const std::string& name, Distribution& d) {
+        for (Distribution c : {Distribution::uniform, Distribution::sorted, Distribution::reversed, Distribution::nearly_sorted,
+                               Distribution::few_unique, Distribution::organ_pipe, Distribution::equal}) {
+            if (name == distribution_name(c)) {
+                d = c;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    namespace gen {
+
+        inline constexpr size_t BLOCK = 1 << 16;        // Keys per independently seeded stream
+        inline constexpr size_t LANES = 4;
+        inline constexpr uint64_t FEW_UNIQUE = 16;      // Distinct keys of few_unique (fewer if max_key < 15)
+        inline constexpr uint64_t NEARLY_PERCENT = 1;   // Keys of nearly_sorted moved at random
+
+        inline uint64_t splitmix64(uint64_t& x) {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        // Four xoshiro256++ generators stepped together
+        class Xoshiro4 {
+        public:
+            Xoshiro4(uint64_t seed, uint64_t stream) {
+                uint64_t x = seed ^ splitmix64(stream);
+                for (size_t w = 0; w < 4; w++) {
+                    for (size_t l = 0; l < LANES; l++) s_[w][l] = splitmix64(x);
+                }
+            }
+
+            void next(uint64_t* out) {
+                for (size_t l = 0; l < LANES; l++) {
+                    out[l] = rotl(s_[0][l] + s_[3][l], 23) + s_[0][l];
+                    uint64_t t = s_[1][l] << 17;
+                    s_[2][l] ^= s_[0][l];
+                    s_[3][l] ^= s_[1][l];
+                    s_[1][l] ^= s_[2][l];
+                    s_[0][l] ^= s_[3][l];
+                    s_[2][l] ^= t;
+                    s_[3][l] = rotl(s_[3][l], 45);
+                }
+            }
+
+        private:
+            uint64_t s_[4][LANES];
+        };
+
+        // High 64 bits of the 128-bit product x * y
+        inline uint64_t mul_high(uint64_t x, uint64_t y) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+            return __umulh(x, y);
+#elif defined(__SIZEOF_INT128__)
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * y) >> 64);
+#else
+            uint64_t x_lo = x & 0xFFFFFFFFu, x_hi = x >> 32, y_lo = y & 0xFFFFFFFFu, y_hi = y >> 32;
+            uint64_t lo_lo = x_lo * y_lo, hi_lo = x_hi * y_lo, lo_hi = x_lo * y_hi;
+            uint64_t mid = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+            return x_hi * y_hi + (hi_lo >> 32) + (mid >> 32);
+#endif
+        }
+
+        // Maps a 64-bit random word to [0, range) (range 0 means 2^64)
+        inline uint64_t bounded(uint64_t x, uint64_t range) {
+            return range ? mul_high(x, range) : x;
+        }
+
+        // Keys on a ramp over [0, max_key]: key i of n is about i * (max_key + 1) / n.
+        // One multiply per key instead of a division; IEEE doubles keep it the same everywhere.
+        struct Ramp {
+            double scale;
+            uint64_t max_key;
+            Ramp(size_t n, uint64_t max_key) : scale((double(max_key) + 1) / double(n)), max_key(max_key) {}
+            uint64_t operator()(size_t i) const { return std::min(max_key, static_cast<uint64_t>(double(i) * scale)); }
+        };
+
+        // Calls put(k, word) for keys k in [first, last) of block b, drawing LANES words per step
+        template<class Put>
+        void draw_block(size_t b, size_t first, size_t last, uint64_t seed, Put put) {
+            Xoshiro4 rng(seed, b);
+            uint64_t r[LANES];
+            size_t i = b * BLOCK;
+            for (; i + LANES <= first; i += LANES) rng.next(r);  // Words before the slice are dropped
+            for (; i < first; i += LANES) {
+                rng.next(r);
+                for (size_t l = 0; l < LANES; l++) {
+                    if (i + l >= first && i + l < last) put(i + l, r[l]);
+                }
+            }
+            for (; i + LANES <= last; i += LANES) {
+                rng.next(r);
+                for (size_t l = 0; l < LANES; l++) put(i + l, r[l]);
+            }
+            for (; i < last; i += LANES) {
+                rng.next(r);
+                for (size_t l = 0; l < LANES; l++) {
+                    if (i + l >= first && i + l < last) put(i + l, r[l]);
+                }
+            }
+        }
+
+        // Writes keys [first, last) of block b (first and last within the block) to out
+        template<class T>
+        void fill_block(T* out, size_t b, size_t first, size_t last, size_t n, uint64_t max_key,
+                        Distribution dist, uint64_t seed) {
+            T* o = out - first;  // Indexed by key number
+            Ramp ramp(n, max_key);
+            switch (dist) {
+            case Distribution::uniform:
+                draw_block(b, first, last, seed, [&](size_t k, uint64_t r) { o[k] = static_cast<T>(bounded(r, max_key + 1)); });
+                break;
+            case Distribution::few_unique: {
+                uint64_t distinct = max_key < FEW_UNIQUE ? max_key + 1 : FEW_UNIQUE;  // Narrow ranges keep every key
+                uint64_t step = max_key / distinct ? max_key / distinct : 1;
+                draw_block(b, first, last, seed, [&](size_t k, uint64_t r) { o[k] = static_cast<T>(bounded(r, distinct) * step); });
+                break;
+            }
+            case Distribution::nearly_sorted:
+                draw_block(b, first, last, seed, [&](size_t k, uint64_t r) {
+                    bool moved = bounded(r, 100) < NEARLY_PERCENT;  // High bits pick, low bits place
+                    o[k] = static_cast<T>(moved ? bounded(r << 8, max_key + 1) : ramp(k));
+                });
+                break;
+            case Distribution::sorted:
+                for (size_t k = first; k < last; k++) o[k] = static_cast<T>(ramp(k));
+                break;
+            case Distribution::reversed:
+                for (size_t k = first; k < last; k++) o[k] = static_cast<T>(ramp(n - 1 - k));
+                break;
+            case Distribution::organ_pipe:
+                for (size_t k = first; k < last; k++) o[k] = static_cast<T>(ramp(std::min(2 * k, 2 * (n - 1 - k))));
+                break;
+            default:
+                std::fill(out, out + (last - first), static_cast<T>(max_key / 2));
+                break;
+            }
+        }
+
+    } // namespace gen
+
+    struct GeneratorOptions {
+        Distribution dist = Distribution::uniform;
+        uint64_t seed = DEFAULT_SEED;
+        unsigned threads = 0;  // 0: every hardware thread
+    };
+
+    // Writes keys [first, last) of the n-key input described by options to out.
+    // Keys lie in [0, max_key] and match those of any other slice of the same input.
+    template<class T>
+    void generate(T* out, size_t first, size_t last, size_t n, uint64_t max_key, const GeneratorOptions& options = {}) {
+        if (first >= last) return;
+        size_t first_block = first / gen::BLOCK, blocks = (last - 1) / gen::BLOCK + 1 - first_block;
+        unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::clamp<size_t>(blocks / 4, 1, threads));
+        samplesort::parallel(threads, [&](unsigned t) {
+            for (size_t b = first_block + blocks * t / threads; b < first_block + blocks * (t + 1) / threads; b++) {
+                size_t lo = std::max(first, b * gen::BLOCK), hi = std::min(last, (b + 1) * gen::BLOCK);
+                gen::fill_block(out + (lo - first), b, lo, hi, n, max_key, options.dist, options.seed);
+            }
+        });
+    }
+
+    // Fills v with its size's worth of keys in [0, max_key]
+    template<class Vec>
+    void generate(Vec& v, uint64_t max_key, const GeneratorOptions& options = {}) {
+        generate(v.data(), 0, v.size(), v.size(), max_key, options);
+    }
+
+} // namespace cam
+
+#endif // DATA_GEN_H
@@ -0,0 +1,175 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "multiway_merge.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+
+// External (disk-spilling) sort of a binary file of fixed-size keys, for
+// inputs that do not fit in memory. Runs of run_keys keys are read, sorted
+// by ping_pong_passes (network chunks, then branchless merges through a temp
+// of run_keys) and written to temporary files; then up to fan_in runs at a
+// time are merged through a loser tree, each streamed through its own read
+// buffer, until one run is left. Resident memory stays near
+// 2 * run_keys * sizeof(T) while forming runs and near the read buffers while
+// merging, whatever the input size.
+namespace cam {
+
+    struct ExternalOptions {
+        size_t run_keys = size_t(1) << 22;   // Keys sorted in memory per run
+        size_t fan_in = 16;                  // Runs merged at once
+        size_t buffer_keys = size_t(1) << 16; // Read buffer per merged run (and the output buffer)
+        std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+    };
+
+    namespace external {
+
+        // Sequential reader of one run file through a fixed buffer
+        template<class T>
+        class RunReader {
+        public:
+            RunReader(const std::filesystem::path& path, size_t buffer_keys)
+                : in_(path, std::ios::binary), buffer_(buffer_keys, buffer_allocator<T>(UNPOOLED)) {
+                if (!in_) throw std::runtime_error("external_sort: cannot open run " + path.string());
+            }
+
+            // Refills the buffer; returns the [begin, end) of keys read (empty at the end)
+            std::pair<const T*, const T*> next() {
+                in_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size() * sizeof(T));
+                size_t got = static_cast<size_t>(in_.gcount()) / sizeof(T);
+                return {buffer_.data(), buffer_.data() + got};
+            }
+
+        private:
+            std::ifstream in_;
+            Buffer<T> buffer_;
+        };
+
+        // Merges the given run files into out, streaming every run through its own buffer
+        template<class T>
+        void merge_files(const std::vector<std::filesystem::path>& runs, const std::filesystem::path& out_path,
+                         size_t buffer_keys) {
+            std::vector<RunReader<T>> readers;
+            readers.reserve(runs.size());
+            std::vector<multiway::Head<T>> heads;
+            for (const auto& run : runs) {
+                readers.emplace_back(run, buffer_keys);
+                auto [first, last] = readers.back().next();
+                heads.push_back({first, last});
+            }
+
+            std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("external_sort: cannot write " + out_path.string());
+            Buffer<T> pending(buffer_keys, buffer_allocator<T>(UNPOOLED));
+            size_t used = 0;
+
+            multiway::LoserTree<T> tree(std::move(heads));
+            while (!tree.done()) {
+                size_t w = tree.winner();
+                auto& h = tree.head(w);
+                pending[used++] = *h.cur++;
+                if (used == pending.size()) {
+                    out.write(reinterpret_cast<const char*>(pending.data()), used * sizeof(T));
+                    used = 0;
+                }
+                if (h.cur == h.end) {
+                    auto [first, last] = readers[w].next();
+                    h.cur = first;
+                    h.end = last;
+                }
+                tree.replay();
+            }
+            out.write(reinterpret_cast<const char*>(pending.data()), used * sizeof(T));
+            if (!out) throw std::runtime_error("external_sort: write failed for " + out_path.string());
+        }
+
+    } // namespace external
+
+    // Sorts the keys of the binary file input into output (may be the same path).
+    // Returns the number of keys sorted. Temporary runs are removed afterwards.
+    template<class T>
+    size_t external_sort(const std::filesystem::path& input, const std::filesystem::path& output,
+                         const ExternalOptions& options = {}) {
+        static_assert(std::is_trivially_copyable_v<T>, "external_sort stores raw key bytes");
+        namespace fs = std::filesystem;
+        size_t run_keys = std::max<size_t>(1, options.run_keys);
+        size_t fan_in = std::max<size_t>(2, options.fan_in);
+
+        std::ifstream in(input, std::ios::binary);
+        if (!in) throw std::runtime_error("external_sort: cannot open " + input.string());
+
+        // Random prefix so concurrent sorts (also in other processes) can share a temp directory
+        std::string prefix = "cam_run_" + std::to_string(std::random_device{}()) + "_" +
+                             std::to_string(reinterpret_cast<uintptr_t>(&in)) + "_";
+        std::vector<fs::path> runs;
+        size_t total = 0, files = 0;
+        auto run_path = [&] { return options.temp_dir / (prefix + std::to_string(files++)); };
+
+        try {
+            // 1. Run formation
+            // Unpooled: every buffer goes back to the OS as soon as its phase ends
+            Buffer<T> keys(run_keys, buffer_allocator<T>(UNPOOLED)), temp(run_keys, buffer_allocator<T>(UNPOOLED));
+            while (true) {
+                in.read(reinterpret_cast<char*>(keys.data()), run_keys * sizeof(T));
+                size_t got = static_cast<size_t>(in.gcount()) / sizeof(T);
+                if (got == 0) break;
+                keys.resize(got);  // Only the last run is short
+                ping_pong_passes(keys.data(), temp.data(), static_cast<ptrdiff_t>(got), std::less<>{});
+                runs.push_back(run_path());
+                std::ofstream out(runs.back(), std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(keys.data()), got * sizeof(T));
+                if (!out) throw std::runtime_error("external_sort: cannot write run " + runs.back().string());
+                total += got;
+                if (got < run_keys) break;
+            }
+            in.close();
+            keys = Buffer<T>();  // Unmap the run buffers before the merge buffers are mapped
+            temp = Buffer<T>();
+
+            // 2. Merge passes of up to fan_in runs each
+            while (runs.size() > 1) {
+                std::vector<fs::path> next;
+                for (size_t i = 0; i < runs.size(); i += fan_in) {
+                    std::vector<fs::path> group(runs.begin() + i, runs.begin() + std::min(i + fan_in, runs.size()));
+                    if (group.size() == 1) {
+                        next.push_back(group[0]);
+                        continue;
+                    }
+                    next.push_back(run_path());
+                    external::merge_files<T>(group, next.back(), options.buffer_keys);
+                    for (const auto& run : group) fs::remove(run);
+                }
+                runs = std::move(next);
+            }
+
+            if (runs.empty()) {
+                std::ofstream(output, std::ios::binary | std::ios::trunc);
+            } else {
+                std::error_code ec;
+                fs::rename(runs[0], output, ec);
+                if (ec) {  // E.g. temp_dir on another file system
+                    fs::copy_file(runs[0], output, fs::copy_options::overwrite_existing);
+                    fs::remove(runs[0]);
+                }
+            }
+        } catch (...) {
+            std::error_code ec;
+            for (const auto& run : runs) fs::remove(run, ec);
+            throw;
+        }
+        return total;
+    }
+
+} // namespace cam
+
+#endif // EXTERNAL_SORT_H
@@ -0,0 +1,76 @@
+#ifndef FLOAT_SORT_H
+#define FLOAT_SORT_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+// Floating-point keys for the integer sort engine.
+// A float is mapped to an unsigned integer whose unsigned order is the IEEE-754
+// total order (-NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN): flip every
+// bit of negatives, flip only the sign bit of positives. The integer kernels
+// then sort the keys with no float comparisons in the hot loop, and the inverse
+// transform restores the exact original bit patterns.
+namespace cam {
+
+    template<class F>
+    using ordered_bits_t = std::conditional_t<sizeof(F) == 4, uint32_t, uint64_t>;
+
+    template<class F>
+    ordered_bits_t<F> to_ordered_bits(F x) noexcept {
+        static_assert(std::numeric_limits<F>::is_iec559, "IEEE-754 float or double expected");
+        using U = ordered_bits_t<F>;
+        constexpr U SIGN = U(1) << (sizeof(U) * 8 - 1);
+        U u = std::bit_cast<U>(x);
+        U mask = U(0) - (u >> (sizeof(U) * 8 - 1));  // all ones for negatives
+        return u ^ (mask | SIGN);
+    }
+
+    template<class F>
+    F from_ordered_bits(ordered_bits_t<F> k) noexcept {
+        using U = ordered_bits_t<F>;
+        constexpr U SIGN = U(1) << (sizeof(U) * 8 - 1);
+        U mask = (k & SIGN) ? SIGN : ~U(0);  // positives carry the sign bit after the transform
+        return std::bit_cast<F>(static_cast<U>(k ^ mask));
+    }
+
+    // Where NaNs end up. IEEE totalOrder splits them by sign bit.
+    enum class NanPlacement { last, first, ieee };
+
+    // Sorts float or double keys in total order: -0 before +0, NaNs grouped per 'nans'.
+    // Keys are transformed into a pooled integer buffer, chunk-sorted and transformed back.
+    template<class Vec>
+    void float_sort(Vec& v, NanPlacement nans = NanPlacement::last) {
+        using F = typename Vec::value_type;
+        using U = ordered_bits_t<F>;
+        size_t n = v.size();
+        if (n < 2) return;
+
+        Buffer<U> keys(n), temp(n);
+        for (size_t i = 0; i < n; i++) keys[i] = to_ordered_bits(v[i]);
+
+        chunk_sort(keys, temp);
+
+        // In key order negative NaNs form a prefix and positive NaNs a suffix
+        U neg_inf = to_ordered_bits(-std::numeric_limits<F>::infinity());
+        U pos_inf = to_ordered_bits(std::numeric_limits<F>::infinity());
+        size_t neg_nans = std::partition_point(keys.begin(), keys.end(), [&](U k) { return k < neg_inf; }) - keys.begin();
+        size_t pos_nans = keys.end() - std::partition_point(keys.begin(), keys.end(), [&](U k) { return k <= pos_inf; });
+
+        if (nans == NanPlacement::last) {
+            std::rotate(keys.begin(), keys.begin() + neg_nans, keys.end());
+        } else if (nans == NanPlacement::first) {
+            std::rotate(keys.begin(), keys.end() - pos_nans, keys.end());
+        }
+
+        for (size_t i = 0; i < n; i++) v[i] = from_ordered_bits<F>(keys[i]);
+    }
+
+} // namespace cam
+
+#endif // FLOAT_SORT_H
@@ -0,0 +1,240 @@
+#ifndef FUNNEL_SORT_H
+#define FUNNEL_SORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+// Lazy funnelsort (Brodal and Fagerberg), a cache-oblivious alternative to
+// chunk_sort with no tuned chunk size. The input is split into about n^(1/3)
+// segments, each is sorted recursively, and the sorted segments are merged by
+// a k-funnel: a binary merge tree whose edges carry buffers. A buffer is
+// refilled only when its consumer finds it empty (the "lazy" rule), and the
+// tree is split recursively into a top tree and bottom trees whose outputs get
+// buffers of k'^(3/2) keys (k' = leaves of the bottom tree). Nodes and buffers
+// are stored in that recursive van Emde Boas order, so every subtree that fits
+// in some cache level is contiguous, whatever the cache sizes are.
+namespace cam {
+
+    namespace funnel {
+
+        // Segments at or below this length are sorted directly: funnels this small
+        // cost more to build than they save, and such a segment fits in L1 anyway
+        inline constexpr ptrdiff_t BASE = 256;
+        inline constexpr ptrdiff_t BLOCK = 16;
+
+        template<class T, class Compare>
+        void insertion_sort(T* a, ptrdiff_t n, Compare comp) {
+            for (ptrdiff_t i = 1; i < n; i++) {
+                T x = a[i];
+                ptrdiff_t j = i;
+                for (; j > 0 && comp(x, a[j - 1]); j--) a[j] = a[j - 1];
+                a[j] = x;
+            }
+        }
+
+        // A k-funnel over sorted input runs, merging them into one output range
+        template<class T, class Compare>
+        class Funnel {
+        public:
+            // Inputs are given as [begin, end) pairs; their count is padded to a power of two
+            Funnel(const std::vector<std::pair<const T*, const T*>>& inputs, Compare comp) : comp_(comp) {
+                leaves_ = 2;
+                while (leaves_ < inputs.size()) leaves_ *= 2;
+                height_ = 0;
+                while ((size_t(1) << height_) < leaves_) height_++;
+
+                // Lay out the inner nodes and their buffers in van Emde Boas order
+                pos_.assign(2 * leaves_, 0);
+                nodes_.reserve(2 * leaves_);
+                size_t buffered = 0;
+                place(1);
+                layout(1, 0, height_, buffered);
+                arena_.resize(buffered);
+                for (auto& node : nodes_) {
+                    if (node.cap && !node.leaf) node.buf = arena_.data() + node.offset;
+                }
+
+                // Leaves read their input runs in place and are never refilled
+                for (size_t k = 0; k < leaves_; k++) {
+                    Node& leaf = node_at(leaves_ + k);
+                    leaf.leaf = true;
+                    leaf.done = true;
+                    if (k < inputs.size()) {
+                        leaf.buf = const_cast<T*>(inputs[k].first);
+                        leaf.tail = inputs[k].second - inputs[k].first;
+                    }
+                }
+                for (size_t id = 1; id < leaves_; id++) {
+                    Node& node = node_at(id);
+                    node.left = pos_[2 * id];
+                    node.right = pos_[2 * id + 1];
+                }
+            }
+
+            // Merges all inputs into out, which must hold their total length
+            void merge(T* out, size_t n) {
+                Node& root = nodes_[pos_[1]];
+                root.buf = out;
+                root.cap = n;
+                fill(root);
+            }
+
+        private:
+            struct Node {
+                T* buf = nullptr;
+                size_t offset = 0;  // Buffer position in the arena
+                size_t cap = 0;
+                size_t head = 0, tail = 0;
+                size_t left = 0, right = 0;  // Child positions in nodes_
+                bool leaf = false;
+                bool done = false;  // Subtree exhausted: no refill can add keys
+            };
+
+            Node& node_at(size_t id) { return nodes_[pos_[id]]; }
+
+            void place(size_t id) {
+                pos_[id] = nodes_.size();
+                nodes_.emplace_back();
+            }
+
+            // Lays out the subtree rooted at id spanning depths [top, top + height]:
+            // the top tree first, then each bottom tree after its root's output buffer.
+            // The node id itself is already placed.
+            void layout(size_t id, uint32_t top, uint32_t height, size_t& buffered) {
+                if (height == 0) return;
+                if (height == 1) {
+                    place(2 * id);
+                    place(2 * id + 1);
+                    return;
+                }
+                uint32_t top_height = (height + 1) / 2;
+                uint32_t bottom_height = height - top_height;
+                layout(id, top, top_height, buffered);
+
+                size_t first = id << top_height;
+                size_t bottom_leaves = size_t(1) << bottom_height;
+                size_t cap = std::max<size_t>(BLOCK, static_cast<size_t>(std::ceil(std::pow(double(bottom_leaves), 1.5))));
+                for (size_t b = first; b < first + (size_t(1) << top_height); b++) {
+                    Node& root = node_at(b);
+                    if (b < leaves_) {
+                        root.offset = buffered;
+                        root.cap = cap;
+                        buffered += cap;
+                    }
+                    layout(b, top + top_height, bottom_height, buffered);
+                }
+            }
+
+            // Fills node's buffer from its children until it is full or they run dry
+            void fill(Node& node) {
+                Node& l = nodes_[node.left];
+                Node& r = nodes_[node.right];
+                node.head = node.tail = 0;
+                T* out = node.buf;
+                size_t space = node.cap;
+                while (space) {
+                    if (l.head == l.tail && !l.done) fill(l);
+                    if (r.head == r.tail && !r.done) fill(r);
+                    size_t la = l.tail - l.head, ra = r.tail - r.head;
+                    if (la == 0 && ra == 0) break;
+                    if (la == 0 || ra == 0) {
+                        Node& src = la ? l : r;
+                        size_t take = std::min(space, la + ra);
+                        std::copy(src.buf + src.head, src.buf + src.head + take, out + node.tail);
+                        src.head += take;
+                        node.tail += take;
+                        space -= take;
+                        continue;
+                    }
+
+                    // Neither child can run dry within 'steps' merge steps
+                    size_t steps = std::min(space, std::min(la, ra));
+                    const T* a = l.buf + l.head;
+                    const T* b = r.buf + r.head;
+                    T* o = out + node.tail;
+                    size_t i = 0, j = 0;
+                    for (size_t s = 0; s < steps; s++) {
+                        const T x = a[i];
+                        const T y = b[j];
+                        bool take_b = comp_(y, x);  // Ties take the left child: stable
+                        o[s] = take_b ? y : x;
+                        j += take_b;
+                        i += !take_b;
+                    }
+                    l.head += i;
+                    r.head += j;
+                    node.tail += steps;
+                    space -= steps;
+                }
+                node.done = l.done && r.done && l.head == l.tail && r.head == r.tail;
+            }
+
+            Compare comp_;
+            size_t leaves_;
+            uint32_t height_;
+            std::vector<size_t> pos_;  // Heap id -> position in nodes_
+            std::vector<Node> nodes_;
+            Buffer<T> arena_;
+        };
+
+        // Base case: insertion-sorted blocks, then branchless merge levels ping-ponging a and tmp
+        template<class T, class Compare>
+        void sort_small(T* a, T* tmp, ptrdiff_t n, bool into_tmp, Compare comp) {
+            for (ptrdiff_t i = 0; i < n; i += BLOCK) insertion_sort(a + i, std::min(BLOCK, n - i), comp);
+            T* src = a;
+            T* dst = tmp;
+            for (ptrdiff_t size = BLOCK; size < n; size *= 2) {
+                merge_level(src, dst, 0, n, size, comp);
+                std::swap(src, dst);
+            }
+            T* want = into_tmp ? tmp : a;
+            if (src != want) std::copy(src, src + n, want);
+        }
+
+        // Sorts a[0, n) with scratch tmp[0, n); the result ends in tmp if into_tmp, else in a
+        template<class T, class Compare>
+        void sort(T* a, T* tmp, ptrdiff_t n, bool into_tmp, Compare comp) {
+            if (n <= BASE) {
+                sort_small(a, tmp, n, into_tmp, comp);
+                return;
+            }
+
+            // About n^(1/3) segments of about n^(2/3) keys each, sorted into the other buffer
+            ptrdiff_t k = std::max<ptrdiff_t>(2, static_cast<ptrdiff_t>(std::ceil(std::cbrt(double(n)))));
+            ptrdiff_t seg = (n + k - 1) / k;
+            T* sorted = into_tmp ? a : tmp;
+            T* out = into_tmp ? tmp : a;
+            std::vector<std::pair<const T*, const T*>> inputs;
+            for (ptrdiff_t i = 0; i < n; i += seg) {
+                ptrdiff_t len = std::min(seg, n - i);
+                sort(a + i, tmp + i, len, !into_tmp, comp);
+                inputs.push_back({sorted + i, sorted + i + len});
+            }
+            Funnel<T, Compare> funnel(inputs, comp);
+            funnel.merge(out, static_cast<size_t>(n));
+        }
+
+    } // namespace funnel
+
+    // Cache-oblivious funnelsort of v[first..last], same contract as chunk_sort:
+    // temp is indexed like v and must have at least last + 1 elements. Stable.
+    template<class Vec, class Compare = std::less<>>
+    void funnel_sort(Vec& v, ptrdiff_t first, ptrdiff_t last, Vec& temp, Compare comp = {}) {
+        if (last <= first) return;
+        funnel::sort(v.data() + first, temp.data() + first, last - first + 1, false, comp);
+    }
+
+    template<class Vec, class Compare = std::less<>>
+    void funnel_sort(Vec& v, Vec& temp, Compare comp = {}) {
+        funnel_sort(v, 0, static_cast<ptrdiff_t>(v.size()) - 1, temp, comp);
+    }
+
+} // namespace cam
+
+#endif // FUNNEL_SORT_H
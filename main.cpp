@@ -7,115 +7,608 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-//#include "cache_size.h" 
+#include "cache_flush.h"
+#include "cache_size.h"
 #include "kaizen.h"
+#include "chunk_sort.h"
+#include "numa_sort.h"
+#include "sort_buffer.h"
+#include "selection.h"
+#include "static_sort.h"
+#include "funnel_sort.h"
+#include "sample_sort.h"
+#include "block_sort.h"
+#include "mem_planner.h"
+#include "unique_sort.h"
+#include "counting_sort.h"
+#include "data_gen.h"
+#include "baseline.h"
+#include "registry.h"
 #include <iomanip>
 #include <format>
-size_t CHUNK_SIZE = 64; // using one cache line  as chunk size write using CacheDetector::CHUNK_SIZE; for L1 cache size
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <filesystem>
+#include <fstream>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
 
-std::pair<int,int> process_args(int argc, char* argv[]) {
+using cam::CHUNK_SIZE;
+using cam::chunk_sort;
+using cam::merge_sort;
+
+struct BenchConfig {
+    size_t size = 500;
+    int iterations = 20;
+    bool numa = false;
+    cam::BufferOptions buffers;
+    size_t top_k = 0;  // 0: no top-k measurement
+    bool unique = false;         // Time sort-then-unique against the fused sort_unique
+    bool prefetch = false;       // Report merge levels with and without prefetching
+    bool prefetch_auto = false;  // Tune the prefetch distance on the generated data
+    bool engines = false;        // Compare chunk_sort with funnel_sort from L1 to DRAM sizes
+    std::string algo = "chunk";  // Engine timed as "Chunk Sort": a registered engine, auto or list
+    size_t mem_limit = 0;        // Memory budget in bytes for one planned sort (0: no budget)
+    cam::GeneratorOptions input; // Key distribution and seed of every generated input
+    std::string save_baseline;   // File to store this run's per-iteration times in
+    std::string baseline;        // File of a stored run to check this one against
+    double threshold = 0.05;     // Tolerated slowdown against the baseline
+    cam::CacheMode cache = cam::CacheMode::warm;  // cold: also time each sort after evicting the caches
+};
+
+// Parses a byte count with an optional K, M or G suffix (binary units)
+size_t parse_bytes(const std::string& text) {
+    size_t pos = 0;
+    long long value = std::stoll(text, &pos);
+    if (value <= 0) throw std::out_of_range("Size must be positive");
+    size_t bytes = static_cast<size_t>(value);
+    std::string suffix = text.substr(pos);
+    if (suffix == "K" || suffix == "k")      bytes <<= 10;
+    else if (suffix == "M" || suffix == "m") bytes <<= 20;
+    else if (suffix == "G" || suffix == "g") bytes <<= 30;
+    else if (!suffix.empty()) throw std::invalid_argument("Unknown size suffix");
+    return bytes;
+}
+
+BenchConfig process_args(int argc, char* argv[]) {
+    BenchConfig config;
     zen::cmd_args args(argv, argc);
     auto size_options = args.get_options("--size");
     auto iter_options = args.get_options("--iter");
+    auto chunk_options = args.get_options("--chunk");
+    auto huge_options = args.get_options("--huge");
+    auto topk_options = args.get_options("--topk");
+    auto merge_options = args.get_options("--merge");
+    auto prefetch_options = args.get_options("--prefetch");
+    auto algo_options = args.get_options("--algo");
+    auto mem_options = args.get_options("--mem-limit");
+    auto seed_options = args.get_options("--seed");
+    auto dist_options = args.get_options("--dist");
+    auto save_options = args.get_options("--save-baseline");
+    auto baseline_options = args.get_options("--baseline");
+    auto threshold_options = args.get_options("--threshold");
+    auto cache_options = args.get_options("--cache");
+    config.numa = args.is_present("--numa");
+    config.engines = args.is_present("--engines");
+    config.unique = args.is_present("--unique");
+
+    if (args.is_present("--huge")) {
+        std::string mode = huge_options.empty() ? "thp" : huge_options[0];
+        if (mode == "thp")           config.buffers.huge = cam::HugePages::transparent;
+        else if (mode == "explicit") config.buffers.huge = cam::HugePages::explicit_;
+        else zen::log("Error: Invalid huge argument, expected thp or explicit!");
+        if (config.buffers.huge != cam::HugePages::none) config.buffers.alignment = cam::HUGE_PAGE;
+    }
+
+    if (!chunk_options.empty()) {
+        try {
+            int chunk = std::stoi(chunk_options[0]);
+            if (chunk < static_cast<int>(sizeof(int))) throw std::out_of_range("Chunk must hold an element");
+            CHUNK_SIZE = chunk;
+        } catch (const std::exception& e) {
+            CHUNK_SIZE = CacheDetector::getCacheLineSize();
+            zen::log(std::format("Error: Invalid chunk argument, using the cache line size of {} bytes!", CHUNK_SIZE));
+        }
+    } else {
+        CHUNK_SIZE = CacheDetector::getCacheLineSize();  // One line per chunk selects a specialized kernel
+    }
+
+    if (!merge_options.empty()) {
+        if (merge_options[0] == "branchless") cam::MERGE_KERNEL = cam::MergeKernel::branchless;
+        else if (merge_options[0] != "gap") zen::log("Error: Invalid merge argument, expected gap or branchless!");
+    }
+
+    if (!algo_options.empty()) {
+        const std::string& algo = algo_options[0];
+        if (algo == "auto" || algo == "list" || cam::find_engine<cam::Buffer<int>>(algo)) {
+            config.algo = algo;
+        } else {
+            std::string names;
+            for (const auto& e : cam::engines<cam::Buffer<int>>()) names += std::string(e.info.name) + ", ";
+            zen::log("Error: Invalid algo argument, expected " + names + "auto or list!");
+        }
+    }
+    if (config.numa && config.algo == "chunk") config.algo = "numa";
+
+    if (!cache_options.empty()) {
+        if (cache_options[0] == "cold") config.cache = cam::CacheMode::cold;
+        else if (cache_options[0] != "warm") zen::log("Error: Invalid cache argument, expected warm or cold!");
+    }
+
+    if (!seed_options.empty()) {
+        try {
+            config.input.seed = std::stoull(seed_options[0], nullptr, 0);
+        } catch (const std::exception& e) {
+            zen::log("Error: Invalid seed argument, using the default seed!");
+        }
+    }
+
+    if (!dist_options.empty() && !cam::parse_distribution(dist_options[0], config.input.dist)) {
+        zen::log("Error: Invalid dist argument, expected uniform, sorted, reversed, nearly-sorted, few-unique, organ-pipe or equal!");
+    }
+
+    if (!save_options.empty()) config.save_baseline = save_options[0];
+    if (!baseline_options.empty()) config.baseline = baseline_options[0];
+    if (!threshold_options.empty()) {
+        try {
+            double percent = std::stod(threshold_options[0]);
+            if (percent < 0) throw std::out_of_range("Threshold must not be negative");
+            config.threshold = percent / 100;
+        } catch (const std::exception& e) {
+            zen::log("Error: Invalid threshold argument, using 5%!");
+        }
+    }
+
+    if (!mem_options.empty()) {
+        try {
+            config.mem_limit = parse_bytes(mem_options[0]);
+        } catch (const std::exception& e) {
+            zen::log("Error: Invalid mem-limit argument, expected bytes with optional K, M or G!");
+        }
+    }
+
+    if (args.is_present("--prefetch")) {
+        config.prefetch = true;
+        if (prefetch_options.empty() || prefetch_options[0] == "auto") {
+            config.prefetch_auto = true;
+        } else {
+            try {
+                long long distance = std::stoll(prefetch_options[0]);
+                if (distance < 0) throw std::out_of_range("Distance must not be negative");
+                cam::PREFETCH_DISTANCE = static_cast<size_t>(distance);
+            } catch (const std::exception& e) {
+                zen::log("Error: Invalid prefetch argument, tuning the distance instead!");
+                config.prefetch_auto = true;
+            }
+        }
+    }
 
+    if (!topk_options.empty()) {
+        try {
+            long long k = std::stoll(topk_options[0]);
+            if (k <= 0) throw std::out_of_range("k must be positive");
+            config.top_k = static_cast<size_t>(k);
+        } catch (const std::exception& e) {
+            zen::log("Error: Invalid topk argument, skipping top-k!");
+        }
+    }
 
     if (size_options.empty()) {
         zen::log("Error: --size argument is absent, using default 500!");
-        return {500, 20};
+        return config;
     }
     try {
-        int size = std::stoi(size_options[0]);
-        int iter =  std::stoi(iter_options[0]);
+        long long size = std::stoll(size_options[0]);  // 64-bit: arrays beyond 2^31 elements
+        int iter = iter_options.empty() ? 20 : std::stoi(iter_options[0]);
         if (size <= 0 || iter <= 0) throw std::out_of_range("Size must be positive");
-        return {size, iter};
+        config.size = static_cast<size_t>(size);
+        config.iterations = iter;
     } catch (const std::exception& e) {
         zen::log("Error: Invalid size argument, using default 500!");
-        return {500, 20};
     }
+    return config;
 }
 
-// Optimized gap-based in-place merge
-int nextGap(int gap) {
-    if (gap <= 1) return 0;
-    return (gap + 1) / 2;
+// Times every merge level of the active kernel at the given prefetch distance.
+// Each level starts from a copy of original whose runs are pre-sorted to that level's length.
+std::vector<double> merge_level_times(const cam::Buffer<int>& original, cam::Buffer<int>& data,
+                                      cam::Buffer<int>& temp, size_t distance) {
+    ptrdiff_t n = static_cast<ptrdiff_t>(original.size());
+    ptrdiff_t run = std::max<ptrdiff_t>(1, CHUNK_SIZE / sizeof(int));
+    size_t saved = cam::PREFETCH_DISTANCE;
+    cam::PREFETCH_DISTANCE = distance;
+    std::vector<double> times;
+    zen::timer timer;
+    for (ptrdiff_t size = run; size < n; size *= 2) {
+        data = original;
+        for (ptrdiff_t i = 0; i < n; i += size) std::sort(data.begin() + i, data.begin() + std::min(i + size, n));
+        timer.start();
+        if (cam::MERGE_KERNEL == cam::MergeKernel::branchless && temp.size() >= original.size()) {
+            cam::merge_level(data.data(), temp.data(), 0, n, size);
+        } else {
+            cam::merge_level(data, 0, n, size);
+        }
+        timer.stop();
+        times.push_back(timer.duration<zen::timer::nsec>().count());
+    }
+    cam::PREFETCH_DISTANCE = saved;
+    return times;
 }
 
-void inPlaceMerge(std::vector<int>& v, int left, int mid, int right) {
-    int gap = nextGap(right - left + 1);
-    while (gap > 0) {
-        for (int i = left; i + gap <= right; i++) {
-            if (v[i] > v[i + gap]) {
-                std::swap(v[i], v[i + gap]);
+// Times chunk_sort (with the selected merge kernel) against the cache-oblivious
+// funnel_sort on working sets (data + temp) that fit L1, L2 and L3, and on one twice
+// the size of L3 that lives in DRAM
+void compare_engines(const BenchConfig& config) {
+    struct Level { const char* name; size_t keys; };
+    std::vector<Level> levels;
+    for (uint32_t level = 1; level <= 3; level++) {
+        size_t bytes = size_t(CacheDetector::getCacheInfo(level).size_kb) * 1024;
+        levels.push_back({level == 1 ? "L1" : level == 2 ? "L2" : "L3", bytes / (2 * sizeof(int))});
+    }
+    levels.push_back({"DRAM", 2 * size_t(CacheDetector::getCacheInfo(3).size_kb) * 1024 / sizeof(int)});
+
+    const int name_width = 12, keys_width = 14, value_width = 22;
+    std::cout << "\n";
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", keys_width, "", value_width, "", value_width);
+    std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|\n", "Working Set", name_width, "Keys", keys_width,
+                             "chunk_sort (ns/key)", value_width, "funnel_sort (ns/key)", value_width);
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", keys_width, "", value_width, "", value_width);
+
+    cam::buffer_allocator<int> alloc(config.buffers);
+    zen::timer timer;
+    for (const auto& level : levels) {
+        cam::Buffer<int> data(level.keys, alloc), original(level.keys, alloc), temp(level.keys, alloc);
+        const int key_max = static_cast<int>(std::min<size_t>(level.keys, std::numeric_limits<int>::max()));
+        cam::generate(original, key_max, config.input);
+
+        // Small sets are repeated so every measurement covers a few million keys
+        int reps = static_cast<int>(std::clamp<size_t>((size_t(1) << 22) / level.keys, 1, config.iterations));
+        auto time = [&](auto sort) {
+            double total = 0.0;
+            for (int r = 0; r < reps; r++) {
+                data = original;
+                timer.start();
+                sort();
+                timer.stop();
+                total += timer.duration<zen::timer::nsec>().count();
+                if (!std::is_sorted(data.begin(), data.end())) zen::log("Error: engine produced unsorted output!");
             }
-        }
-        gap = nextGap(gap);
+            return total / reps / level.keys;
+        };
+        double chunk = time([&] { chunk_sort(data, temp); });
+        double funnel = time([&] { cam::funnel_sort(data, temp); });
+        std::cout << std::format("|{:^{}}|{:^{}}|{:^{}.2f}|{:^{}.2f}|\n", level.name, name_width, level.keys, keys_width,
+                                 chunk, value_width, funnel, value_width);
+    }
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", keys_width, "", value_width, "", value_width);
+}
+
+#ifdef CAM_CACHE_SIM
+// Reads "--sim-l1 KB WAYS LINE" style overrides for the simulated hierarchy
+CacheDetector::CacheInfo sim_geometry(const zen::cmd_args& args, const std::string& flag, uint32_t level) {
+    CacheDetector::CacheInfo info = CacheDetector::getCacheInfo(level);
+    auto options = args.get_options(flag);
+    try {
+        if (options.size() > 0) info.size_kb   = std::stoul(options[0]);
+        if (options.size() > 1) info.ways      = std::stoul(options[1]);
+        if (options.size() > 2) info.line_size = std::stoul(options[2]);
+        if (info.size_kb == 0 || info.ways == 0 || info.line_size == 0) throw std::out_of_range("Geometry must be positive");
+        info.sets = std::max<uint32_t>(1, info.size_kb * 1024 / (info.ways * info.line_size));
+    } catch (const std::exception& e) {
+        zen::log("Error: Invalid " + flag + " argument, using detected geometry!");
+        info = CacheDetector::getCacheInfo(level);
+    }
+    return info;
+}
+
+// Runs one traced sort against cold simulated caches and prints the misses per phase
+template<class Vec, class Sort>
+void simulate(const char* label, Vec& data, const Vec& original, Sort sort) {
+    auto& sim = cam::sim::tracer();
+    data = original;
+    sim.reset();
+    sim.enable(true);
+    sort();
+    sim.enable(false);
+
+    const int phase_width = 28;
+    const int count_width = 14;
+    std::cout << std::format("\nCache simulation: {}\n", label);
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", phase_width - 2,
+                             "", count_width - 2, "", count_width - 2, "", count_width - 2, "", count_width - 2, "", count_width - 2);
+    std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|\n", "Phase", phase_width - 2,
+                             "Loads", count_width - 2, "Stores", count_width - 2,
+                             "L1 Misses", count_width - 2, "L2 Misses", count_width - 2, "L3 Misses", count_width - 2);
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", phase_width - 2,
+                             "", count_width - 2, "", count_width - 2, "", count_width - 2, "", count_width - 2, "", count_width - 2);
+    for (const auto& p : sim.phases()) {
+        std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|\n", p.name, phase_width - 2,
+                                 p.loads, count_width - 2, p.stores, count_width - 2,
+                                 p.misses[0], count_width - 2, p.misses[1], count_width - 2, p.misses[2], count_width - 2);
     }
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", phase_width - 2,
+                             "", count_width - 2, "", count_width - 2, "", count_width - 2, "", count_width - 2, "", count_width - 2);
 }
+#endif
 
-// Optimized merge sort with minimal temporary space
-void merge_sort(std::vector<int>& v, int left, int right, std::vector<int>& temp) {
-    if (left >= right) return;
-    
-    int mid = left + (right - left) / 2;
-    merge_sort(v, left, mid, temp);
-    merge_sort(v, mid + 1, right, temp);
-    inPlaceMerge(v, left, mid, right);
+// Peak resident set of the process in bytes (0 where unavailable)
+size_t peak_rss() {
+#ifdef __linux__
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) return static_cast<size_t>(usage.ru_maxrss) * 1024;  // Reported in KB
+#endif
+    return 0;
 }
 
-// Optimized chunk sort using merge sort throughout
-void chunk_sort(std::vector<int>& v, std::vector<int>& temp) {
-    int n = v.size();
-    int chunk_size = std::max(1, static_cast<int>(CHUNK_SIZE / sizeof(int))); // 16 ints = 64 bytes
+// One sort of config.size random keys planned within config.mem_limit. In-memory
+// plans sort a generated buffer; external plans stream the keys through files.
+int run_within_budget(const BenchConfig& config) {
+    namespace fs = std::filesystem;
+    const size_t size = config.size;
+    const int key_max = static_cast<int>(std::min<size_t>(size, std::numeric_limits<int>::max()));
+    cam::SortPlan plan = cam::plan_sort<int>(size, config.mem_limit);
+    std::cout << std::format("Memory budget: {} bytes for {} keys\n", config.mem_limit, size);
+    std::cout << std::format("Plan: {}, expected peak {} bytes{}\n", cam::strategy_name(plan.strategy), plan.peak_bytes,
+                             plan.fits ? "" : " (exceeds the budget)");
+    if (plan.strategy == cam::SortStrategy::external) {
+        std::cout << std::format("Runs of {} keys, fan-in {}, read buffers of {} keys\n", plan.external.run_keys,
+                                 plan.external.fan_in, plan.external.buffer_keys);
+    }
+
+    zen::timer timer;
+    bool sorted = true;
+    if (plan.strategy != cam::SortStrategy::external) {
+        cam::Buffer<int> data(size);
+        cam::generate(data, key_max, config.input);
+        timer.start();
+        cam::sort_within_budget(data, config.mem_limit);
+        timer.stop();
+        sorted = std::is_sorted(data.begin(), data.end());
+    } else {
+        // Keys are generated and checked in blocks so only the sort holds the budget
+        const size_t block = 1 << 16;
+        std::vector<int> keys(block);
+        fs::path dir = fs::temp_directory_path();
+        fs::path input = dir / std::format("cam_budget_{}.in", reinterpret_cast<uintptr_t>(&keys));
+        fs::path output = dir / std::format("cam_budget_{}.out", reinterpret_cast<uintptr_t>(&keys));
+        long long sum = 0;
+        {
+            std::ofstream out(input, std::ios::binary | std::ios::trunc);
+            for (size_t i = 0; i < size; i += block) {
+                size_t n = std::min(block, size - i);
+                cam::generate(keys.data(), i, i + n, size, key_max, config.input);  // Same keys as an in-memory input
+                sum = std::accumulate(keys.begin(), keys.begin() + n, sum);
+                out.write(reinterpret_cast<const char*>(keys.data()), n * sizeof(int));
+            }
+        }
+        timer.start();
+        cam::sort_file_within_budget<int>(input, output, config.mem_limit);
+        timer.stop();
+
+        std::ifstream in(output, std::ios::binary);
+        size_t count = 0;
+        int last = std::numeric_limits<int>::min();
+        while (in.read(reinterpret_cast<char*>(keys.data()), block * sizeof(int)) || in.gcount() > 0) {
+            size_t n = static_cast<size_t>(in.gcount()) / sizeof(int);
+            for (size_t j = 0; j < n; j++) {
+                sorted &= last <= keys[j];
+                last = keys[j];
+                sum -= keys[j];
+            }
+            count += n;
+        }
+        sorted &= count == size && sum == 0;
+        in.close();
+        std::error_code ec;
+        fs::remove(input, ec);
+        fs::remove(output, ec);
+    }
+
+    std::cout << std::format("Sort time: {} us, sorted: {}\n", static_cast<long long>(timer.duration<zen::timer::usec>().count()),
+                             sorted ? "yes" : "no");
+    if (size_t rss = peak_rss()) std::cout << std::format("Peak RSS of the process: {} bytes\n", rss);
+    return sorted ? 0 : 1;
+}
 
-    for (int i = 0; i < n; i += chunk_size) {
-        int end = std::min(i + chunk_size - 1, n - 1);
-        merge_sort(v, i, end, temp);
+// Prints the engine registry for --algo list
+void list_engines() {
+    const int name_width = 12, desc_width = 50, flag_width = 10, memory_width = 22;
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", desc_width, "", flag_width,
+                             "", flag_width, "", flag_width, "", memory_width);
+    std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|\n", "Engine", name_width, "Description", desc_width,
+                             "Stable", flag_width, "Parallel", flag_width, "Temp", flag_width, "Extra Memory", memory_width);
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", desc_width, "", flag_width,
+                             "", flag_width, "", flag_width, "", memory_width);
+    for (const auto& e : cam::engines<cam::Buffer<int>>()) {
+        const auto& i = e.info;
+        std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|\n", i.name, name_width,
+                                 std::string(i.description) + (i.integer_only ? " (integers)" : ""), desc_width,
+                                 i.stable ? "yes" : "no", flag_width, i.parallel ? "yes" : "no", flag_width,
+                                 i.needs_temp ? "n keys" : "none", flag_width, i.memory, memory_width);
     }
+    std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", desc_width, "", flag_width,
+                             "", flag_width, "", flag_width, "", memory_width);
+}
 
-    for (int size = chunk_size; size < n; size *= 2) {
-        for (int i = 0; i < n; i += 2 * size) {
-            int mid = std::min(i + size - 1, n - 1);
-            int right_end = std::min(i + 2 * size - 1, n - 1);
-            if (mid < right_end) {
-                inPlaceMerge(v, i, mid, right_end);
+// Checks the cases against config.baseline and/or stores them in config.save_baseline.
+// Returns the exit status: 1 if a case regressed, 2 if a baseline file failed.
+int baseline_gate(const BenchConfig& config, const std::vector<cam::bench::Case>& cases) {
+    int status = 0;
+    if (!config.baseline.empty()) {
+        std::vector<cam::bench::Case> stored;
+        try {
+            stored = cam::bench::load_baseline(config.baseline);
+        } catch (const std::exception& e) {
+            zen::log(std::string("Error: ") + e.what());
+            return 2;
+        }
+        const int name_width = 72, value_width = 14, ci_width = 20;
+        std::cout << std::format("\nBaseline {} (regression: slower by over {:.1f}% with p < 0.05)\n", config.baseline, config.threshold * 100);
+        std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", value_width, "", value_width,
+                                 "", ci_width, "", value_width, "", value_width);
+        std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}}|\n", "Case", name_width, "Base (ns)", value_width, "Now (ns)",
+                                 value_width, "Speedup [95% CI]", ci_width, "p", value_width, "Verdict", value_width);
+        std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", value_width, "", value_width,
+                                 "", ci_width, "", value_width, "", value_width);
+        for (const auto& now : cases) {
+            auto base = std::find_if(stored.begin(), stored.end(), [&](const auto& c) { return c.name == now.name; });
+            if (base == stored.end()) {
+                std::cout << std::format("|{:^{}}|{:^{}}|\n", now.name, name_width, "not in baseline",
+                                         4 * value_width + ci_width + 4);
+                continue;
             }
+            auto cmp = cam::bench::compare(*base, now, config.threshold);
+            const char* verdict = cmp.regressed ? "REGRESSED" : cmp.p < 0.05 && cmp.speedup > 1 ? "faster" : "same";
+            if (cmp.regressed) status = 1;
+            std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|{:^{}}|{:^{}.4f}|{:^{}}|\n", now.name, name_width,
+                                     static_cast<long long>(cmp.base_median), value_width, static_cast<long long>(cmp.new_median), value_width,
+                                     std::format("{:.3f} [{:.3f}, {:.3f}]", cmp.speedup, cmp.speedup_lo, cmp.speedup_hi), ci_width,
+                                     cmp.p, value_width, verdict, value_width);
         }
+        std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", name_width, "", value_width, "", value_width,
+                                 "", ci_width, "", value_width, "", value_width);
     }
+    if (!config.save_baseline.empty()) {
+        try {
+            cam::bench::save_baseline(config.save_baseline, cases);
+            std::cout << std::format("Saved baseline {}\n", config.save_baseline);
+        } catch (const std::exception& e) {
+            zen::log(std::string("Error: ") + e.what());
+            status = std::max(status, 2);
+        }
+    }
+    return status;
 }
 
 int main(int argc, char* argv[]) {
-    auto [size, iterations] = process_args(argc, argv);
+    const BenchConfig config = process_args(argc, argv);
+    const size_t size = config.size;
+    const int iterations = config.iterations;
     zen::timer timer;
 
     // Print chunk size using std::cout and std::format
-    std::cout << std::format("Using chunk size: {} bytes ({} integers)\n", CHUNK_SIZE * sizeof(int), CHUNK_SIZE);
-
-    std::vector<int> data(size), original(size), temp(size);
+    std::cout << std::format("Using chunk size: {} bytes ({} integers)\n", CHUNK_SIZE, CHUNK_SIZE / sizeof(int));
+    if (config.algo == "list") {
+        list_engines();
+        return 0;
+    }
+    const auto* engine = cam::find_engine<cam::Buffer<int>>(config.algo);  // nullptr for auto
+    if (engine && config.algo != "chunk") std::cout << std::format("Engine: {}\n", engine->info.description);
+    std::cout << std::format("Input: {} keys, seed {}\n", cam::distribution_name(config.input.dist), config.input.seed);
+    if (config.mem_limit) return run_within_budget(config);
 
-    // Warm-up run
-    for (int i = 0; i < size; i++) {
-        original[i] = zen::random_int(0, size);
+    // Buffers are aligned and left uninitialized, so each NUMA node's partition is
+    // first-touched by a thread on that node (no-op on single-node machines)
+    auto topology = cam::numa::Topology::detect();
+    cam::buffer_allocator<int> alloc(config.buffers);
+    // Engines that need no full-size temp (blocksort: O(sqrt n)) run without it (peak ~2x instead of ~3x)
+    size_t temp_size = !engine || engine->info.needs_temp ? size : 0;
+    cam::Buffer<int> data(size, alloc), original(size, alloc), temp(temp_size, alloc);
+    cam::numa::first_touch(data, topology);
+    cam::numa::first_touch(temp, topology);
+    if (config.numa) {
+        std::cout << std::format("NUMA mode: {} node(s)\n", topology.nodes());
     }
+    auto sort_chunks = [&] {
+        if (engine) engine->sort(data, temp);
+        else        cam::auto_sort(data, temp);
+    };
+
+    // Warm-up run; every timed sort's output is checked too, outside the timer
+    const int key_max = static_cast<int>(std::min<size_t>(size, std::numeric_limits<int>::max()));
+    cam::generate(original, key_max, config.input);
     data = original;
-    chunk_sort(data, temp);
+    sort_chunks();
+    bool is_correct = std::is_sorted(data.begin(), data.end());
+    if (!engine) {
+        cam::InputProfile profile = cam::profile(original);
+        std::cout << std::format("Auto: {:.1f}% ascending, {:.1f}% descending, {:.1f}% distinct, {} range -> {}\n",
+                                 profile.ascending * 100, profile.descending * 100, profile.distinct * 100,
+                                 profile.small_range ? "small" : "wide", cam::choose_engine<cam::Buffer<int>>(profile, temp.size() >= size));
+    }
+
+    // Prefetch tuning: the distance with the lowest total merge time over all levels
+    if (config.prefetch_auto) {
+        double best = std::numeric_limits<double>::max();
+        for (size_t distance : {0, 64, 128, 256, 512, 1024, 2048}) {
+            auto times = merge_level_times(original, data, temp, distance);
+            double total = std::accumulate(times.begin(), times.end(), 0.0);
+            if (total < best) {
+                best = total;
+                cam::PREFETCH_DISTANCE = distance;
+            }
+        }
+        std::cout << std::format("Tuned prefetch distance: {} bytes\n", cam::PREFETCH_DISTANCE);
+    }
+
+    // Cold runs start from a fresh copy evicted from every cache level
+    const bool cold = config.cache == cam::CacheMode::cold;
+    std::optional<cam::CacheFlusher> flusher;
+    if (cold) {
+        flusher.emplace();
+        std::cout << std::format("Cache: cold runs after a {} MB sweep and clflush of the data\n", flusher->sweep_bytes() >> 20);
+    }
+    auto time_cold = [&](auto sort, double& total, std::vector<double>& samples) {
+        data = original;
+        flusher->evict(data, temp);
+        timer.start();
+        sort();
+        timer.stop();
+        total += timer.duration<zen::timer::nsec>().count();
+        samples.push_back(timer.duration<zen::timer::nsec>().count());
+        is_correct &= std::is_sorted(data.begin(), data.end());
+    };
 
     // Performance measurement
-    double chunk_total = 0.0, merge_total = 0.0;
+    double chunk_total = 0.0, merge_total = 0.0, topk_total = 0.0, scan_unique_total = 0.0, fused_unique_total = 0.0;
+    double chunk_cold_total = 0.0, merge_cold_total = 0.0;
+    std::vector<double> chunk_samples, merge_samples, chunk_cold_samples, merge_cold_samples;  // Per-iteration times for baselines
     for (int iter = 0; iter < iterations; iter++) {
         data = original;
         timer.start();
-        chunk_sort(data, temp);
+        sort_chunks();
         timer.stop();
         chunk_total += timer.duration<zen::timer::nsec>().count();
+        chunk_samples.push_back(timer.duration<zen::timer::nsec>().count());
+        is_correct &= std::is_sorted(data.begin(), data.end());
 
         data = original;
         timer.start();
-        merge_sort(data, 0, size - 1, temp);
+        merge_sort(data, 0, static_cast<ptrdiff_t>(size) - 1, temp);
         timer.stop();
         merge_total += timer.duration<zen::timer::nsec>().count();
-    }
+        merge_samples.push_back(timer.duration<zen::timer::nsec>().count());
+        is_correct &= std::is_sorted(data.begin(), data.end());
 
-    bool is_correct = std::is_sorted(data.begin(), data.end());
+        if (cold) {
+            time_cold(sort_chunks, chunk_cold_total, chunk_cold_samples);
+            time_cold([&] { merge_sort(data, 0, static_cast<ptrdiff_t>(size) - 1, temp); }, merge_cold_total, merge_cold_samples);
+        }
+
+        if (config.top_k) {
+            timer.start();
+            auto smallest = cam::top_k(original, config.top_k);
+            timer.stop();
+            topk_total += timer.duration<zen::timer::nsec>().count();
+        }
+
+        if (config.unique) {
+            cam::Buffer<int> keys = original;
+            timer.start();
+            cam::chunk_sort_auto(keys, temp);
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            timer.stop();
+            scan_unique_total += timer.duration<zen::timer::nsec>().count();
+
+            keys = original;
+            timer.start();
+            cam::sort_unique(keys);
+            timer.stop();
+            fused_unique_total += timer.duration<zen::timer::nsec>().count();
+        }
+    }
 
     // Table output using std::cout and std::format with centered alignment
     const int metric_width = 25;  // Width for the "Metric" column
@@ -133,6 +626,17 @@ int main(int argc, char* argv[]) {
     std::cout << std::format("|{:^{}}|{:^{}}|\n", "Sort Correctness", metric_width - 2, (is_correct ? "Verified" : "Failed"), value_width - 2);
     std::cout << std::format("|{:^{}}|{:^{}}|\n", "Avg Chunk Sort (ns)", metric_width - 2, static_cast<long long>(chunk_total / iterations), value_width - 2);
     std::cout << std::format("|{:^{}}|{:^{}}|\n", "Avg Merge Sort (ns)", metric_width - 2, static_cast<long long>(merge_total / iterations), value_width - 2);
+    if (cold) {
+        std::cout << std::format("|{:^{}}|{:^{}}|\n", "Cold Chunk Sort (ns)", metric_width - 2, static_cast<long long>(chunk_cold_total / iterations), value_width - 2);
+        std::cout << std::format("|{:^{}}|{:^{}}|\n", "Cold Merge Sort (ns)", metric_width - 2, static_cast<long long>(merge_cold_total / iterations), value_width - 2);
+    }
+    if (config.top_k) {
+        std::cout << std::format("|{:^{}}|{:^{}}|\n", std::format("Avg Top-{} (ns)", config.top_k), metric_width - 2, static_cast<long long>(topk_total / iterations), value_width - 2);
+    }
+    if (config.unique) {
+        std::cout << std::format("|{:^{}}|{:^{}}|\n", "Avg Sort+Unique (ns)", metric_width - 2, static_cast<long long>(scan_unique_total / iterations), value_width - 2);
+        std::cout << std::format("|{:^{}}|{:^{}}|\n", "Avg Fused Unique (ns)", metric_width - 2, static_cast<long long>(fused_unique_total / iterations), value_width - 2);
+    }
 
     // Print table footer
     std::cout << std::format("+{:-^{}}+{:-^{}}+\n", "", metric_width - 2, "", value_width - 2);
@@ -144,5 +648,51 @@ int main(int argc, char* argv[]) {
     std::cout << std::format("|{:^{}}|{:^{}.5f}|\n", "Speedup Factor", metric_width - 2, speed_ratio, value_width - 2);
     std::cout << std::format("+{:-^{}}+{:-^{}}+\n", "", metric_width - 2, "", value_width - 2);
 
-    return 0;
+    // Regression gate: cases are named by everything that changes their timings
+    int status = 0;
+    if (!config.baseline.empty() || !config.save_baseline.empty()) {
+        std::string params = std::format("n={} {} seed={} chunk={}B merge={}", size, cam::distribution_name(config.input.dist),
+                                         config.input.seed, CHUNK_SIZE,
+                                         cam::MERGE_KERNEL == cam::MergeKernel::branchless ? "branchless" : "gap");
+        std::vector<cam::bench::Case> cases{{std::format("Chunk Sort ({}) {}", config.algo, params), chunk_samples},
+                                            {std::format("Merge Sort {}", params), merge_samples}};
+        if (cold) {
+            cases.push_back({std::format("Chunk Sort ({}) {} cache=cold", config.algo, params), chunk_cold_samples});
+            cases.push_back({std::format("Merge Sort {} cache=cold", params), merge_cold_samples});
+        }
+        status = baseline_gate(config, cases);
+    }
+
+    // Per-level effect of software prefetching on the active merge kernel
+    if (config.prefetch) {
+        auto plain = merge_level_times(original, data, temp, 0);
+        auto hinted = merge_level_times(original, data, temp, cam::PREFETCH_DISTANCE);
+        std::string hinted_title = std::format("Prefetch {} B (ns)", cam::PREFETCH_DISTANCE);
+        std::cout << "\n";
+        std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", metric_width - 2, "", value_width + 8, "", value_width + 8);
+        std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|\n", "Merge Run (keys)", metric_width - 2, "No Prefetch (ns)", value_width + 8, hinted_title, value_width + 8);
+        std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", metric_width - 2, "", value_width + 8, "", value_width + 8);
+        size_t run = std::max<size_t>(1, CHUNK_SIZE / sizeof(int));
+        for (size_t level = 0; level < plain.size(); level++, run *= 2) {
+            std::cout << std::format("|{:^{}}|{:^{}}|{:^{}}|\n", run, metric_width - 2, static_cast<long long>(plain[level]), value_width + 8,
+                                     static_cast<long long>(hinted[level]), value_width + 8);
+        }
+        std::cout << std::format("+{:-^{}}+{:-^{}}+{:-^{}}+\n", "", metric_width - 2, "", value_width + 8, "", value_width + 8);
+    }
+
+    if (config.engines) compare_engines(config);
+
+#ifdef CAM_CACHE_SIM
+    zen::cmd_args args(argv, argc);
+    cam::sim::tracer().configure(sim_geometry(args, "--sim-l1", 1),
+                                 sim_geometry(args, "--sim-l2", 2),
+                                 sim_geometry(args, "--sim-l3", 3));
+    simulate("Chunk Sort", data, original, [&] { chunk_sort(data, temp); });
+    simulate("Merge Sort", data, original, [&] {
+        CAM_TRACE_PHASE("merge_sort");
+        merge_sort(data, 0, static_cast<ptrdiff_t>(size) - 1, temp);
+    });
+#endif
+
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef MEM_PLANNER_H
+#define MEM_PLANNER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include "block_sort.h"
+#include "chunk_sort.h"
+#include "external_sort.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+
+// Memory-budget planner: picks the fastest strategy whose peak memory fits a
+// budget, so many concurrent sorts stay inside their quotas.
+//   ping_pong   keys + full temp (2n keys), branchless merges through temp
+//   block_merge keys + sqrt(n) buffer, stable block merges in place
+//   external    keys stay on disk; runs sized to the budget are sorted in
+//               memory and merged from files through small read buffers
+// Peaks count the sort's own buffers, including the keys when they are in memory.
+namespace cam {
+
+    enum class SortStrategy { ping_pong, block_merge, external };
+
+    inline const char* strategy_name(SortStrategy s) {
+        switch (s) {
+        case SortStrategy::ping_pong:   return "ping-pong (full temp)";
+        case SortStrategy::block_merge: return "block merge (sqrt n buffer)";
+        default:                        return "external (spill to disk)";
+        }
+    }
+
+    struct SortPlan {
+        SortStrategy strategy = SortStrategy::ping_pong;
+        size_t keys = 0;
+        size_t budget_bytes = 0;
+        size_t peak_bytes = 0;     // Expected peak of the sort's buffers
+        bool fits = true;          // peak_bytes <= budget_bytes
+        ExternalOptions external;  // Run and buffer sizes for the external strategy
+    };
+
+    namespace planner {
+
+        inline constexpr size_t MIN_RUN_KEYS = 1 << 12;
+        inline constexpr size_t MIN_READ_KEYS = 1 << 12;
+        inline constexpr size_t MAX_READ_KEYS = 1 << 16;
+        inline constexpr size_t STREAM_OVERHEAD = 1 << 13;  // Per open file stream
+
+        template<class T>
+        size_t ping_pong_bytes(size_t n) { return 2 * n * sizeof(T); }
+
+        template<class T>
+        size_t block_merge_bytes(size_t n) {
+            size_t buffer = static_cast<size_t>(std::ceil(std::sqrt(double(n))));
+            return n * sizeof(T) + buffer * (sizeof(T) + sizeof(ptrdiff_t));  // Buffer and block tags
+        }
+
+    } // namespace planner
+
+    // Plans a sort of n keys of type T within budget_bytes
+    template<class T>
+    SortPlan plan_sort(size_t n, size_t budget_bytes) {
+        using namespace planner;
+        SortPlan plan;
+        plan.keys = n;
+        plan.budget_bytes = budget_bytes;
+
+        if (ping_pong_bytes<T>(n) <= budget_bytes) {
+            plan.strategy = SortStrategy::ping_pong;
+            plan.peak_bytes = ping_pong_bytes<T>(n);
+            return plan;
+        }
+        if (block_merge_bytes<T>(n) <= budget_bytes) {
+            plan.strategy = SortStrategy::block_merge;
+            plan.peak_bytes = block_merge_bytes<T>(n);
+            return plan;
+        }
+
+        // Runs are ping-pong sorted in memory (keys + scratch); the merge splits the budget over
+        // fan_in read buffers and one output buffer
+        plan.strategy = SortStrategy::external;
+        ExternalOptions& ext = plan.external;
+        ext.run_keys = std::max(MIN_RUN_KEYS, budget_bytes / (2 * sizeof(T)));
+        size_t runs = (n + ext.run_keys - 1) / ext.run_keys;
+        size_t min_stream = MIN_READ_KEYS * sizeof(T) + STREAM_OVERHEAD;
+        ext.fan_in = std::clamp<size_t>(budget_bytes / min_stream, 3, std::max<size_t>(3, runs + 1)) - 1;
+        size_t per_stream = budget_bytes / (ext.fan_in + 1);
+        size_t read_keys = per_stream > STREAM_OVERHEAD ? (per_stream - STREAM_OVERHEAD) / sizeof(T) : 0;
+        ext.buffer_keys = std::clamp<size_t>(read_keys, MIN_READ_KEYS, MAX_READ_KEYS);
+
+        size_t run_phase = 2 * ext.run_keys * sizeof(T);
+        size_t merge_phase = (ext.fan_in + 1) * (ext.buffer_keys * sizeof(T) + STREAM_OVERHEAD);
+        plan.peak_bytes = std::max(run_phase, merge_phase);
+        plan.fits = plan.peak_bytes <= budget_bytes;
+        return plan;
+    }
+
+    // Ping-pong sort: network-sorted base chunks, then branchless merge levels through a full
+    // scratch buffer allocated with scratch_options (UNPOOLED hands it back to the OS on return)
+    template<class Vec, class Compare = std::less<>>
+    void ping_pong_sort(Vec& v, Compare comp = {}, const BufferOptions& scratch_options = {}) {
+        using T = typename Vec::value_type;
+        ptrdiff_t n = static_cast<ptrdiff_t>(v.size());
+        Buffer<T> scratch(v.size(), buffer_allocator<T>(scratch_options));
+        ping_pong_passes(v.data(), scratch.data(), n, comp);
+    }
+
+    // Sorts keys already in memory within budget_bytes (the keys count towards it).
+    // If the keys alone exceed the budget, the block merge is used and the plan says it does not fit.
+    template<class Vec>
+    SortPlan sort_within_budget(Vec& v, size_t budget_bytes) {
+        using T = typename Vec::value_type;
+        SortPlan plan = plan_sort<T>(v.size(), budget_bytes);
+        if (plan.strategy == SortStrategy::external) {
+            plan.strategy = SortStrategy::block_merge;
+            plan.peak_bytes = planner::block_merge_bytes<T>(v.size());
+            plan.fits = false;
+        }
+        // The scratch is unpooled so it does not stay mapped past the budgeted sort
+        if (plan.strategy == SortStrategy::ping_pong) ping_pong_sort(v, std::less<>{}, UNPOOLED);
+        else                                          block_sort(v, std::less<>{}, UNPOOLED);
+        return plan;
+    }
+
+    // Sorts the binary key file input into output within budget_bytes, loading it
+    // into memory when the plan allows and spilling runs to disk otherwise
+    template<class T>
+    SortPlan sort_file_within_budget(const std::filesystem::path& input, const std::filesystem::path& output,
+                                     size_t budget_bytes) {
+        size_t n = std::filesystem::file_size(input) / sizeof(T);
+        SortPlan plan = plan_sort<T>(n, budget_bytes);
+        if (plan.strategy == SortStrategy::external) {
+            external_sort<T>(input, output, plan.external);
+            return plan;
+        }
+
+        Buffer<T> keys(n, buffer_allocator<T>(UNPOOLED));  // Keys and scratch go back to the OS, not to the pool
+        {
+            std::ifstream in(input, std::ios::binary);
+            in.read(reinterpret_cast<char*>(keys.data()), n * sizeof(T));
+            if (!in) throw std::runtime_error("sort_file_within_budget: cannot read " + input.string());
+        }
+        if (plan.strategy == SortStrategy::ping_pong) ping_pong_sort(keys, std::less<>{}, UNPOOLED);
+        else                                          block_sort(keys, std::less<>{}, UNPOOLED);
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(keys.data()), n * sizeof(T));
+        if (!out) throw std::runtime_error("sort_file_within_budget: cannot write " + output.string());
+        return plan;
+    }
+
+} // namespace cam
+
+#endif // MEM_PLANNER_H
@@ -0,0 +1,206 @@
+#ifndef MULTIWAY_MERGE_H
+#define MULTIWAY_MERGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Merge of k already-sorted shards into one sorted output in a single
+// streaming pass, instead of concatenating them and running chunk_sort.
+// Shards are read in place and every key is written straight to its final
+// position. The output is split into independent parts by sampled splitters
+// and the parts are merged in parallel. Within a part a loser tree picks the
+// next shard, and a shard on a winning streak gallops: all of its keys below
+// the runner-up's head are found by exponential search and copied in one
+// block, so skewed shards cost O(log run) comparisons per run, not per key.
+namespace cam {
+
+    namespace multiway {
+
+        template<class T>
+        struct Head {
+            const T* cur;
+            const T* end;
+        };
+
+        // Number of leading keys of [first, last) that precede 'bound', where first[0] is
+        // known to precede bound; wins_ties says whether keys equal to bound still precede it
+        template<class T>
+        size_t gallop(const T* first, const T* last, const T& bound, bool wins_ties) {
+            auto precedes = [&](const T& x) { return wins_ties ? !(bound < x) : x < bound; };
+            size_t len = last - first;
+            size_t hi = 1;
+            while (hi < len && precedes(first[hi])) hi *= 2;
+            size_t lo = hi / 2;
+            hi = std::min(hi, len);
+            return std::partition_point(first + lo + 1, first + hi, precedes) - first;
+        }
+
+        // Tournament (loser) tree over the shard heads: the winner sits in tree[0] and
+        // each inner node keeps the loser of its match, so replacing the winner replays
+        // only the log k matches on its path. Ties go to the lower shard, which keeps the
+        // merge stable; exhausted shards lose every match.
+        template<class T>
+        class LoserTree {
+        public:
+            explicit LoserTree(std::vector<Head<T>> heads) : heads_(std::move(heads)) {
+                leaves_ = 2;  // A lone shard still has a (dead) runner-up to gallop against
+                while (leaves_ < heads_.size()) leaves_ *= 2;
+                heads_.resize(leaves_, Head<T>{nullptr, nullptr});
+                keys_.resize(leaves_);
+                dead_.resize(leaves_);
+                for (size_t k = 0; k < leaves_; k++) refresh(k);
+                tree_.assign(leaves_, 0);
+                tree_[0] = build(1);
+            }
+
+            size_t winner() const { return tree_[0]; }
+            bool done() const { return exhausted(tree_[0]); }
+            Head<T>& head(size_t k) { return heads_[k]; }
+
+            // Best of the matches the current winner played, i.e. the runner-up
+            size_t runner_up() const {
+                size_t best = leaves_;
+                for (size_t node = (tree_[0] + leaves_) / 2; node >= 1; node /= 2) {
+                    if (best == leaves_ || less(tree_[node], best)) best = tree_[node];
+                }
+                return best;
+            }
+
+            bool exhausted(size_t k) const { return dead_[k]; }
+
+            // Re-runs the winner's matches after its head advanced
+            void replay() {
+                size_t w = tree_[0];
+                refresh(w);
+                for (size_t node = (w + leaves_) / 2; node >= 1; node /= 2) {
+                    size_t other = tree_[node];
+                    bool swap = less(other, w);  // Selects instead of branching on random keys
+                    tree_[node] = swap ? w : other;
+                    w = swap ? other : w;
+                }
+                tree_[0] = w;
+            }
+
+        private:
+            // Head keys are cached next to the tree so a match touches no shard memory
+            void refresh(size_t k) {
+                dead_[k] = heads_[k].cur == heads_[k].end;
+                if (!dead_[k]) keys_[k] = *heads_[k].cur;
+            }
+
+            bool less(size_t a, size_t b) const {
+                if (dead_[a] | dead_[b]) return dead_[b] && !dead_[a];
+                if (keys_[a] < keys_[b]) return true;
+                if (keys_[b] < keys_[a]) return false;
+                return a < b;
+            }
+
+            // Plays the matches below node and returns the subtree's winner
+            size_t build(size_t node) {
+                if (node >= leaves_) return node - leaves_;
+                size_t a = build(2 * node), b = build(2 * node + 1);
+                if (less(b, a)) std::swap(a, b);
+                tree_[node] = b;
+                return a;
+            }
+
+            std::vector<Head<T>> heads_;
+            std::vector<T> keys_;
+            std::vector<unsigned char> dead_;
+            std::vector<size_t> tree_;
+            size_t leaves_;
+        };
+
+        // Sequential k-way merge of the given ranges into out.
+        // After a shard wins GALLOP_AFTER times in a row, its whole run below the
+        // runner-up is located by exponential search and copied as one block.
+        template<class T>
+        void merge(std::vector<Head<T>> heads, T* out) {
+            constexpr int GALLOP_AFTER = 4;
+            if (heads.empty()) return;
+            LoserTree<T> tree(std::move(heads));
+            size_t last = ~size_t(0);
+            int streak = 0;
+            while (!tree.done()) {
+                size_t w = tree.winner();
+                Head<T>& h = tree.head(w);
+                streak = (w == last) ? streak + 1 : 0;
+                last = w;
+                if (streak >= GALLOP_AFTER) {
+                    size_t r = tree.runner_up();
+                    size_t run = tree.exhausted(r) ? size_t(h.end - h.cur)
+                                                   : gallop(h.cur, h.end, *tree.head(r).cur, w < r);
+                    out = std::copy(h.cur, h.cur + run, out);
+                    h.cur += run;
+                    streak = 0;
+                } else {
+                    *out++ = *h.cur++;
+                }
+                tree.replay();
+            }
+        }
+
+    } // namespace multiway
+
+    // Merges sorted shards into out (out.size() must equal the total shard size).
+    // Stable: equal keys keep shard order. threads == 0 uses every hardware thread.
+    template<class T>
+    void merge_sorted(const std::vector<std::span<const T>>& shards, std::span<T> out, unsigned threads = 0) {
+        using multiway::Head;
+        size_t total = 0;
+        for (const auto& s : shards) total += s.size();
+        if (out.size() != total) throw std::invalid_argument("merge_sorted: output size must equal the total shard size");
+
+        constexpr size_t MIN_PART = 1 << 16;  // Below this a thread costs more than it saves
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t parts = std::max<size_t>(1, std::min<size_t>(threads, total / MIN_PART));
+
+        if (parts == 1) {
+            std::vector<Head<T>> heads;
+            for (const auto& s : shards) heads.push_back({s.data(), s.data() + s.size()});
+            multiway::merge(std::move(heads), out.data());
+            return;
+        }
+
+        // Splitters: quantiles of a sample drawn from every shard in proportion to its size
+        std::vector<T> sample;
+        size_t sample_size = parts * 32;
+        for (const auto& s : shards) {
+            size_t take = (s.size() * sample_size + total - 1) / total;
+            for (size_t i = 0; i < take && i < s.size(); i++) sample.push_back(s[(2 * i + 1) * s.size() / (2 * take)]);
+        }
+        std::sort(sample.begin(), sample.end());
+
+        // cut[p][k]: where part p starts in shard k; keys equal to a splitter all go right
+        std::vector<std::vector<size_t>> cut(parts + 1, std::vector<size_t>(shards.size()));
+        for (size_t k = 0; k < shards.size(); k++) cut[parts][k] = shards[k].size();
+        for (size_t p = 1; p < parts; p++) {
+            const T& splitter = sample[p * sample.size() / parts];
+            for (size_t k = 0; k < shards.size(); k++) {
+                cut[p][k] = std::lower_bound(shards[k].begin(), shards[k].end(), splitter) - shards[k].begin();
+            }
+        }
+
+        std::vector<std::thread> workers;
+        size_t offset = 0;
+        for (size_t p = 0; p < parts; p++) {
+            std::vector<Head<T>> heads;
+            size_t part_size = 0;
+            for (size_t k = 0; k < shards.size(); k++) {
+                heads.push_back({shards[k].data() + cut[p][k], shards[k].data() + cut[p + 1][k]});
+                part_size += cut[p + 1][k] - cut[p][k];
+            }
+            T* dst = out.data() + offset;
+            workers.emplace_back([heads = std::move(heads), dst]() mutable { multiway::merge(std::move(heads), dst); });
+            offset += part_size;
+        }
+        for (auto& w : workers) w.join();
+    }
+
+} // namespace cam
+
+#endif // MULTIWAY_MERGE_H
@@ -0,0 +1,240 @@
+#ifndef NUMA_SORT_H
+#define NUMA_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// NUMA-aware parallel chunk sort.
+// Each node owns a contiguous partition of the buffers. The partition is
+// first-touched, sorted and merged only by threads bound to that node's CPUs,
+// so the interconnect is crossed only in the cross-node merges, where every
+// thread reads both runs but writes its own node's part of the output.
+// On single-node machines (and off Linux) everything falls back to chunk_sort.
+namespace cam::numa {
+
+    struct Topology {
+        std::vector<std::vector<int>> node_cpus;  // CPU ids per online node
+
+        size_t nodes() const { return node_cpus.size(); }
+
+        // Reads the online nodes and their CPU lists from /sys/devices/system/node
+        static Topology detect() {
+            Topology topo;
+#ifdef __linux__
+            for (int node : parse_cpulist(read_line("/sys/devices/system/node/online"))) {
+                auto cpus = parse_cpulist(read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+                if (!cpus.empty()) topo.node_cpus.push_back(cpus);
+            }
+#endif
+            if (topo.node_cpus.empty()) topo.node_cpus.push_back({});  // One node, unbound
+            return topo;
+        }
+
+        // Parses the kernel list format, e.g. "0-3,8-11"
+        static std::vector<int> parse_cpulist(const std::string& list) {
+            std::vector<int> ids;
+            std::stringstream ss(list);
+            std::string range;
+            while (std::getline(ss, range, ',')) {
+                if (range.empty()) continue;
+                try {
+                    size_t dash = range.find('-');
+                    int lo = std::stoi(range.substr(0, dash));
+                    int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+                    for (int id = lo; id <= hi; id++) ids.push_back(id);
+                } catch (const std::exception&) {
+                    return {};
+                }
+            }
+            return ids;
+        }
+
+    private:
+        static std::string read_line(const std::string& path) {
+            std::ifstream in(path);
+            std::string line;
+            std::getline(in, line);
+            return line;
+        }
+    };
+
+    // Pins the calling thread to the given CPUs (no-op when the list is empty)
+    inline void bind_to(const std::vector<int>& cpus) {
+#ifdef __linux__
+        if (cpus.empty()) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpus;
+#endif
+    }
+
+    // [first, last) element range owned by a node
+    inline std::pair<ptrdiff_t, ptrdiff_t> partition(ptrdiff_t n, size_t node, size_t nodes) {
+        return {static_cast<ptrdiff_t>(n * node / nodes),
+                static_cast<ptrdiff_t>(n * (node + 1) / nodes)};
+    }
+
+    // Runs fn(node) on one thread per node, each bound to that node's CPUs
+    template<class Fn>
+    void for_each_node(const Topology& topo, Fn fn) {
+        std::vector<std::thread> threads;
+        for (size_t node = 0; node < topo.nodes(); node++) {
+            threads.emplace_back([&, node] {
+                bind_to(topo.node_cpus[node]);
+                fn(node);
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    // Share [first, last) of the output written by one thread bound to *cpus
+    struct Worker {
+        ptrdiff_t first;
+        ptrdiff_t last;
+        const std::vector<int>* cpus;
+    };
+
+    // Splits [first, last) into one share per CPU (at most one per 1024 keys)
+    inline void add_workers(std::vector<Worker>& workers, ptrdiff_t first, ptrdiff_t last, const std::vector<int>& cpus) {
+        size_t count = std::max<size_t>(1, std::min<size_t>(cpus.size(), (last - first) / 1024 + 1));
+        for (size_t s = 0; s < count; s++) {
+            workers.push_back({first + static_cast<ptrdiff_t>((last - first) * s / count),
+                               first + static_cast<ptrdiff_t>((last - first) * (s + 1) / count), &cpus});
+        }
+    }
+
+    // Runs fn(worker) on one thread per worker, each bound to its CPUs
+    template<class Fn>
+    void run_workers(const std::vector<Worker>& workers, Fn fn) {
+        std::vector<std::thread> threads;
+        for (const Worker& w : workers) {
+            threads.emplace_back([&fn, &w] {
+                bind_to(*w.cpus);
+                fn(w);
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    // Keys of a among the first k outputs of the stable merge of a and b (merge-path co-rank)
+    template<class T>
+    ptrdiff_t co_rank(ptrdiff_t k, const T* a, ptrdiff_t na, const T* b, ptrdiff_t nb) {
+        ptrdiff_t lo = std::max<ptrdiff_t>(0, k - nb), hi = std::min(k, na);
+        while (lo < hi) {
+            ptrdiff_t i = lo + (hi - lo) / 2;
+            if (!(b[k - i - 1] < a[i])) lo = i + 1;  // a[i] precedes b[k - i - 1], so it is among the first k
+            else                        hi = i;
+        }
+        return lo;
+    }
+
+    // Writes outputs [k0, k1) of the stable merge of a and b to out + k0
+    template<class T>
+    void merge_piece(const T* a, ptrdiff_t na, const T* b, ptrdiff_t nb, T* out, ptrdiff_t k0, ptrdiff_t k1) {
+        ptrdiff_t i0 = co_rank(k0, a, na, b, nb), i1 = co_rank(k1, a, na, b, nb);
+        ptrdiff_t j0 = k0 - i0, j1 = k1 - i1;
+        if (i0 == i1)      std::copy(b + j0, b + j1, out + k0);
+        else if (j0 == j1) std::copy(a + i0, a + i1, out + k0);
+        else               branchlessMerge(a + i0, i1 - i0, b + j0, j1 - j0, out + k0);
+    }
+
+    // Merges the sorted runs [bounds[k], bounds[k+1]) of src pairwise until one run is left,
+    // ping-ponging between src and dst. Every round is co-ranked over all the workers, each
+    // writing its own share of the output, so a large merge still uses every thread.
+    // Returns the buffer holding the result.
+    template<class T>
+    T* merge_runs(T* src, T* dst, std::vector<ptrdiff_t> bounds, const std::vector<Worker>& workers) {
+        while (bounds.size() > 2) {
+            std::vector<ptrdiff_t> next;
+            for (size_t k = 0; k + 1 < bounds.size(); k += 2) next.push_back(bounds[k]);
+            next.push_back(bounds.back());
+            run_workers(workers, [&](const Worker& w) {
+                for (size_t k = 0; k + 1 < bounds.size(); k += 2) {
+                    ptrdiff_t left = bounds[k], mid = bounds[k + 1], right = k + 2 < bounds.size() ? bounds[k + 2] : mid;
+                    ptrdiff_t lo = std::max(left, w.first), hi = std::min(right, w.last);
+                    if (lo < hi) merge_piece(src + left, mid - left, src + mid, right - mid, dst + left, lo - left, hi - left);
+                }
+            });
+            std::swap(src, dst);
+            bounds = std::move(next);
+        }
+        return src;
+    }
+
+    // Copies each worker's share of src back to dst
+    template<class T>
+    void copy_back(const T* src, T* dst, const std::vector<Worker>& workers) {
+        run_workers(workers, [&](const Worker& w) { std::copy(src + w.first, src + w.last, dst + w.first); });
+    }
+
+    // Gives every node's partition of v its first touch from a thread on that node.
+    // Call on freshly allocated, uninitialized buffers (see cam::Buffer).
+    template<class Vec>
+    void first_touch(Vec& v, const Topology& topo) {
+        if (topo.nodes() <= 1) return;
+        ptrdiff_t n = static_cast<ptrdiff_t>(v.size());
+        for_each_node(topo, [&](size_t node) {
+            auto [first, last] = partition(n, node, topo.nodes());
+            std::fill(v.begin() + first, v.begin() + last, 0);
+        });
+    }
+
+    // Node-local parallel chunk sort followed by the cross-node merge rounds.
+    // Assumes v and temp were placed with first_touch using the same topology.
+    // Merges ping-pong between v and temp with branchless kernels; every thread writes
+    // only its node's part of the output, and all of them share each cross-node merge.
+    template<class Vec>
+    void chunk_sort(Vec& v, Vec& temp, const Topology& topo) {
+        if (topo.nodes() <= 1) {
+            cam::chunk_sort(v, temp);
+            return;
+        }
+
+        using T = typename Vec::value_type;
+        ptrdiff_t n = static_cast<ptrdiff_t>(v.size());
+        std::vector<std::vector<Worker>> node_workers(topo.nodes());
+        std::vector<Worker> all;
+        for (size_t node = 0; node < topo.nodes(); node++) {
+            auto [first, last] = partition(n, node, topo.nodes());
+            add_workers(node_workers[node], first, last, topo.node_cpus[node]);
+            all.insert(all.end(), node_workers[node].begin(), node_workers[node].end());
+        }
+
+        // One slice per worker, then node-local merges back into v
+        run_workers(all, [&](const Worker& w) {
+            if (w.first < w.last) cam::chunk_sort(v, w.first, w.last - 1, temp);
+        });
+        for_each_node(topo, [&](size_t node) {
+            const auto& workers = node_workers[node];
+            std::vector<ptrdiff_t> bounds;
+            for (const Worker& w : workers) bounds.push_back(w.first);
+            bounds.push_back(workers.back().last);
+            if (merge_runs(v.data(), temp.data(), bounds, workers) != v.data()) copy_back(temp.data(), v.data(), workers);
+        });
+
+        // Cross-node merge rounds of the node partitions, shared by every thread
+        std::vector<ptrdiff_t> bounds;
+        for (size_t node = 0; node <= topo.nodes(); node++) bounds.push_back(partition(n, node, topo.nodes()).first);
+        T* result = merge_runs(v.data(), temp.data(), bounds, all);
+        if (result != v.data()) copy_back(temp.data(), v.data(), all);
+    }
+
+} // namespace cam::numa
+
+#endif // NUMA_SORT_H
@@ -0,0 +1,180 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "block_sort.h"
+#include "chunk_sort.h"
+#include "counting_sort.h"
+#include "funnel_sort.h"
+#include "mem_planner.h"
+#include "numa_sort.h"
+#include "resort.h"
+#include "sample_sort.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+#include "unique_sort.h"
+
+// Registry of the sort engines behind one signature, sort(v, temp), with what
+// a caller needs to pick one: stability, memory, key types and parallelism.
+// "auto" profiles the input from a small sample (plus the vectorized range
+// scan for integers) and dispatches:
+//   small integer range        counting
+//   (nearly) sorted/reversed   resort, which extracts the few misplaced keys
+//   few distinct integers      counts (duplicates collapse in the merges)
+//   large, several threads     samplesort
+//   otherwise                  pingpong, or blocksort without a full temp
+namespace cam {
+
+    struct EngineInfo {
+        const char* name;
+        const char* description;
+        bool stable;          // Equal keys keep their order
+        bool parallel;        // Uses several threads
+        bool integer_only;    // Only registered for integer keys
+        bool needs_temp;      // temp must hold v.size() keys; otherwise it may be empty
+        const char* memory;   // Extra memory besides temp
+    };
+
+    template<class Vec>
+    struct Engine {
+        EngineInfo info;
+        std::function<void(Vec&, Vec&)> sort;
+    };
+
+    // What auto dispatch knows about an input
+    struct InputProfile {
+        size_t keys = 0;
+        double ascending = 0;     // Sampled adjacent pairs in order
+        double descending = 0;    // Sampled adjacent pairs strictly descending
+        double distinct = 1;      // Distinct keys per key of a sample
+        bool small_range = false; // Integer keys for the counting path
+    };
+
+    namespace registry {
+
+        inline constexpr size_t SAMPLE = 1024;
+        inline constexpr double PRESORTED = 0.99;    // Sampled pairs in order for resort
+        inline constexpr double FEW_DISTINCT = 1.0 / 16;
+        inline constexpr size_t PARALLEL_KEYS = size_t(1) << 20;
+
+        // Expands sort_counts output back to v: equal integers are interchangeable
+        template<class Vec>
+        void counts_sort(Vec& v) {
+            Vec keys(v.begin(), v.end());
+            Buffer<size_t> counts;
+            size_t unique = sort_counts(keys, counts);
+            auto out = v.begin();
+            for (size_t i = 0; i < unique; i++) out = std::fill_n(out, counts[i], keys[i]);
+        }
+
+    } // namespace registry
+
+    // Every engine registered for Vec's key type, in listing order
+    template<class Vec>
+    const std::vector<Engine<Vec>>& engines() {
+        using T = typename Vec::value_type;
+        static const std::vector<Engine<Vec>> list = [] {
+            std::vector<Engine<Vec>> e;
+            e.push_back({{"chunk", "chunk sort (network chunks + merge passes)", false, false, false, true, "none"},
+                         [](Vec& v, Vec& temp) { chunk_sort_auto(v, temp); }});
+            e.push_back({{"pingpong", "chunk sort with branchless ping-pong merges", false, false, false, false, "n keys"},
+                         [](Vec& v, Vec&) { ping_pong_sort(v); }});
+            e.push_back({{"merge", "recursive merge sort with in-place merges", false, false, false, false, "O(log n) stack"},
+                         [](Vec& v, Vec& temp) { merge_sort(v, 0, static_cast<ptrdiff_t>(v.size()) - 1, temp); }});
+            e.push_back({{"blocksort", "stable block merge sort", true, false, false, false, "O(sqrt n) keys"},
+                         [](Vec& v, Vec&) { block_sort(v); }});
+            e.push_back({{"funnel", "cache-oblivious lazy funnelsort", true, false, false, true, "O(n) funnel buffers"},
+                         [](Vec& v, Vec& temp) { funnel_sort(v, temp); }});
+            e.push_back({{"samplesort", "parallel samplesort", false, true, false, true, "n bucket ids"},
+                         [](Vec& v, Vec& temp) { sample_sort(v, temp); }});
+            e.push_back({{"numa", "NUMA-aware chunk sort", false, true, false, true, "none"},
+                         [](Vec& v, Vec& temp) {
+                             static const numa::Topology topology = numa::Topology::detect();
+                             numa::chunk_sort(v, temp, topology);
+                         }});
+            e.push_back({{"resort", "incremental re-sort of misplaced keys", false, false, false, false, "misplaced keys"},
+                         [](Vec& v, Vec&) { resort(v); }});
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+                // Counting needs no temp; auto picks it only for small ranges, and a wide one merges in place
+                e.push_back({{"counting", "counting sort for small key ranges", false, true, true, false, "L2-sized counters"},
+                             [](Vec& v, Vec& temp) { range_sort(v, temp); }});
+                e.push_back({{"counts", "sort with duplicates collapsed", false, false, true, false, "n keys"},
+                             [](Vec& v, Vec&) { registry::counts_sort(v); }});
+            }
+            return e;
+        }();
+        return list;
+    }
+
+    // Engine named name, or nullptr
+    template<class Vec>
+    const Engine<Vec>* find_engine(const std::string& name) {
+        for (const auto& e : engines<Vec>()) {
+            if (name == e.info.name) return &e;
+        }
+        return nullptr;
+    }
+
+    // Samples the input: evenly spaced adjacent pairs and keys, plus the range scan for integers
+    template<class Vec>
+    InputProfile profile(const Vec& v) {
+        using T = typename Vec::value_type;
+        using namespace registry;
+        InputProfile p;
+        size_t n = v.size();
+        p.keys = n;
+        if (n < 2) return p;
+
+        size_t samples = std::min(SAMPLE, n - 1);
+        size_t asc = 0, desc = 0;
+        std::vector<T> keys;
+        keys.reserve(samples);
+        for (size_t s = 0; s < samples; s++) {
+            size_t i = (n - 1) * s / samples;
+            asc += !(v[i + 1] < v[i]);
+            desc += v[i + 1] < v[i];
+            keys.push_back(v[i]);
+        }
+        p.ascending = double(asc) / samples;
+        p.descending = double(desc) / samples;
+        std::sort(keys.begin(), keys.end());
+        p.distinct = double(std::unique(keys.begin(), keys.end()) - keys.begin()) / samples;
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            p.small_range = counting_applies(key_range(v), n);
+        }
+        return p;
+    }
+
+    // Name of the engine auto dispatch uses for the profile
+    template<class Vec>
+    const char* choose_engine(const InputProfile& p, bool full_temp) {
+        using T = typename Vec::value_type;
+        using namespace registry;
+        constexpr bool integers = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+        if (integers && p.small_range) return "counting";
+        if (p.ascending >= PRESORTED || p.descending >= PRESORTED) return "resort";
+        if (integers && p.distinct <= FEW_DISTINCT) return "counts";
+        if (p.keys >= PARALLEL_KEYS && std::thread::hardware_concurrency() > 1 && full_temp) return "samplesort";
+        return full_temp ? "pingpong" : "blocksort";
+    }
+
+    // Profiles v and sorts it with the chosen engine; returns the engine's name.
+    // temp may be empty, which rules out the engines that need it.
+    template<class Vec>
+    const char* auto_sort(Vec& v, Vec& temp) {
+        InputProfile p = profile(v);
+        const char* name = choose_engine<Vec>(p, temp.size() >= v.size());
+        if (p.descending >= registry::PRESORTED) std::reverse(v.begin(), v.end());  // resort then sees a near-sorted input
+        find_engine<Vec>(name)->sort(v, temp);
+        return name;
+    }
+
+} // namespace cam
+
+#endif // REGISTRY_H
@@ -0,0 +1,133 @@
+#ifndef RESORT_H
+#define RESORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "sort_buffer.h"
+#include "static_sort.h"
+
+// Incremental re-sort of a sorted array after a few localized updates.
+// The clean keys are compacted to the front of v and the dirty ones pulled into
+// a small buffer, which is sorted by the chunked kernel; one merge from the back
+// then fills v from its end, so the clean keys move at most once more and no
+// full-size scratch is needed. Cost: O(n) sequential work plus a sort of the
+// dirty keys, instead of a full sort.
+namespace cam {
+
+    // Half-open index range [first, last) of updated keys
+    struct DirtyRange {
+        size_t first;
+        size_t last;
+    };
+
+    namespace resorting {
+
+        // Merges the sorted runs v[0, clean) and d into v[0, clean + d.size()) from the
+        // back; v has room for both. Dirty keys are few, so for each one (from the
+        // largest) a galloping search finds the clean keys above it, which move as a block.
+        // Ties keep the clean key first.
+        template<class T, class Compare>
+        void merge_back(T* v, size_t clean, const T* d, size_t nd, Compare comp) {
+            T* out = v + clean + nd;
+            T* a = v + clean;
+            for (const T* b = d + nd; b > d; ) {
+                const T& key = *--b;
+                // Gallop down from a until a clean key <= key, then binary search the last step
+                size_t step = 1;
+                T* lo = a;
+                T* hi = a;
+                while (lo > v && comp(key, *(lo - 1))) {
+                    hi = lo;
+                    lo = hi - std::min<size_t>(step, hi - v);
+                    step *= 2;
+                }
+                T* first = std::upper_bound(lo, hi, key, comp);
+                CAM_TRACE_LOAD(first);
+                out = std::copy_backward(first, a, out);
+                a = first;
+                *--out = key;
+            }
+        }
+
+        template<class Vec, class Compare>
+        void sort_and_merge(Vec& v, size_t clean, Buffer<typename Vec::value_type>& dirty, Compare comp) {
+            Buffer<typename Vec::value_type> temp(dirty.size());
+            switch (CHUNK_SIZE) {  // chunk_sort_auto with the caller's comparator
+            case 32:  chunk_sort_fixed<32>(dirty, temp, comp);  break;
+            case 128: chunk_sort_fixed<128>(dirty, temp, comp); break;
+            case 256: chunk_sort_fixed<256>(dirty, temp, comp); break;
+            default:  chunk_sort_fixed<64>(dirty, temp, comp);  break;
+            }
+            CAM_TRACE_PHASE("resort: merge back");
+            merge_back(v.data(), clean, dirty.data(), dirty.size(), comp);
+        }
+
+    } // namespace resorting
+
+    // Restores the order of v, sorted except for the keys in the given ranges
+    // (which may overlap and come in any order). Keys outside the ranges must be in order.
+    template<class Vec, class Compare = std::less<>>
+    void resort(Vec& v, std::vector<DirtyRange> ranges, Compare comp = {}) {
+        using T = typename Vec::value_type;
+        size_t n = v.size();
+        std::sort(ranges.begin(), ranges.end(), [](const DirtyRange& a, const DirtyRange& b) { return a.first < b.first; });
+
+        CAM_TRACE_PHASE("resort: extract");
+        Buffer<T> dirty;
+        T* a = v.data();
+        size_t w = 0, i = 0;
+        for (const DirtyRange& r : ranges) {
+            size_t first = std::max(std::min(r.first, n), i), last = std::min(r.last, n);
+            if (first >= last) continue;
+            if (w != i) std::copy(a + i, a + first, a + w);
+            w += first - i;
+            dirty.insert(dirty.end(), a + first, a + last);
+            i = last;
+        }
+        if (dirty.empty()) return;
+        std::copy(a + i, a + n, a + w);
+        resorting::sort_and_merge(v, n - dirty.size(), dirty, comp);
+    }
+
+    // Restores the order of v after localized updates, finding the out-of-order keys itself.
+    // One pass keeps a nondecreasing subsequence of clean keys. A key below the last
+    // clean key is pulled out, unless the next LOOKAHEAD keys are below that clean key
+    // too, which marks the clean key as the outlier instead. Any choice keeps the result
+    // sorted; the lookahead only keeps the pulled keys few. Returns how many were re-sorted.
+    template<class Vec, class Compare = std::less<>>
+    size_t resort(Vec& v, Compare comp = {}) {
+        using T = typename Vec::value_type;
+        constexpr size_t LOOKAHEAD = 4;
+        size_t n = v.size();
+        CAM_TRACE_PHASE("resort: detect");
+        T* a = v.data();
+        size_t i = 1;
+        while (i < n && !comp(a[i], a[i - 1])) i++;  // Sorted prefix stays in place
+        if (i >= n) return 0;
+
+        auto high_outlier = [&](size_t i, const T& key) {
+            size_t end = std::min(n, i + 1 + LOOKAHEAD);
+            if (end == i + 1) return false;  // Nothing to compare with: pull the last key instead
+            for (size_t j = i + 1; j < end; j++) {
+                if (!comp(a[j], key)) return false;
+            }
+            return true;
+        };
+        Buffer<T> dirty;
+        size_t w = i;  // a[0, w) is the clean subsequence
+        for (; i < n; i++) {
+            T x = a[i];
+            while (w > 0 && comp(x, a[w - 1]) && high_outlier(i, a[w - 1])) dirty.push_back(a[--w]);
+            if (w > 0 && comp(x, a[w - 1])) dirty.push_back(x);
+            else                             a[w++] = x;
+        }
+        if (dirty.empty()) return 0;
+        resorting::sort_and_merge(v, w, dirty, comp);
+        return dirty.size();
+    }
+
+} // namespace cam
+
+#endif // RESORT_H
@@ -0,0 +1,174 @@
+#ifndef SAMPLE_SORT_H
+#define SAMPLE_SORT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+
+// Parallel samplesort (super scalar samplesort): one distribution pass
+// instead of log(P) global merge levels.
+// 1. Splitters are the quantiles of an oversampled, sorted random sample.
+// 2. Each thread classifies its block with a branch-free walk down an implicit
+//    search tree of the splitters, recording a bucket id per key.
+// 3. Per-thread bucket counts give every (bucket, thread) pair its own output
+//    range, so each thread scatters its block into temp once with no locking.
+// 4. Threads take buckets from a shared counter and sort them locally with
+//    network chunks and branchless ping-pong merges (v's bucket range is the scratch).
+namespace cam {
+
+    namespace samplesort {
+
+        inline constexpr size_t MAX_BUCKETS = 256;    // Bucket ids fit in one byte
+        inline constexpr size_t OVERSAMPLE = 16;      // Sample keys per bucket
+        inline constexpr ptrdiff_t MIN_BUCKET = 4096; // Smaller buckets cost more to set up than they save
+        inline constexpr ptrdiff_t MIN_SIZE = 1 << 15;
+
+        // Implicit search tree over k - 1 sorted splitters (k a power of two):
+        // node j has children 2j and 2j + 1, so classification needs no pointers
+        template<class T>
+        class Classifier {
+        public:
+            explicit Classifier(std::vector<T> splitters) {
+                log_k_ = 1;
+                while ((size_t(1) << log_k_) < splitters.size() + 1) log_k_++;
+                k_ = size_t(1) << log_k_;
+                splitters.resize(k_ - 1, splitters.back());  // Padding leaves the top buckets empty
+                tree_.resize(k_);
+                build(splitters, 1, 0, k_ - 1);
+            }
+
+            size_t buckets() const { return k_; }
+
+            // Bucket b holds the keys in (splitter[b - 1], splitter[b]]
+            void classify(const T* keys, size_t n, uint8_t* ids) const {
+                constexpr size_t UNROLL = 8;  // Independent walks overlap their load latencies
+                size_t i = 0;
+                for (; i + UNROLL <= n; i += UNROLL) {
+                    size_t j[UNROLL];
+                    for (size_t u = 0; u < UNROLL; u++) j[u] = 1;
+                    for (uint32_t level = 0; level < log_k_; level++) {
+                        for (size_t u = 0; u < UNROLL; u++) j[u] = 2 * j[u] + (tree_[j[u]] < keys[i + u]);
+                    }
+                    for (size_t u = 0; u < UNROLL; u++) ids[i + u] = static_cast<uint8_t>(j[u] - k_);
+                }
+                for (; i < n; i++) {
+                    size_t j = 1;
+                    for (uint32_t level = 0; level < log_k_; level++) j = 2 * j + (tree_[j] < keys[i]);
+                    ids[i] = static_cast<uint8_t>(j - k_);
+                }
+            }
+
+        private:
+            // In-order placement: node j gets the median of splitters [lo, hi)
+            void build(const std::vector<T>& s, size_t j, size_t lo, size_t hi) {
+                if (lo >= hi) return;
+                size_t mid = lo + (hi - lo) / 2;
+                tree_[j] = s[mid];
+                build(s, 2 * j, lo, mid);
+                build(s, 2 * j + 1, mid + 1, hi);
+            }
+
+            std::vector<T> tree_;
+            size_t k_;
+            uint32_t log_k_;
+        };
+
+        // Runs fn(t) on threads t = 0..threads-1
+        template<class Fn>
+        void parallel(unsigned threads, Fn fn) {
+            std::vector<std::thread> workers;
+            for (unsigned t = 1; t < threads; t++) workers.emplace_back(fn, t);
+            fn(0u);
+            for (auto& w : workers) w.join();
+        }
+
+    } // namespace samplesort
+
+    // Parallel samplesort of v, same contract as chunk_sort (temp has v's size).
+    // Not stable. threads == 0 uses every hardware thread.
+    template<class Vec>
+    void sample_sort(Vec& v, Vec& temp, unsigned threads = 0) {
+        using T = typename Vec::value_type;
+        using namespace samplesort;
+        ptrdiff_t n = static_cast<ptrdiff_t>(v.size());
+        if (n < MIN_SIZE) {
+            ping_pong_passes(v.data(), temp.data(), n, std::less<>{});
+            return;
+        }
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // 1. Oversampled splitters from pseudo-random positions
+        size_t k = std::min<size_t>(MAX_BUCKETS, std::max<ptrdiff_t>(2, n / MIN_BUCKET));
+        Buffer<T> sample(k * OVERSAMPLE), sample_temp(k * OVERSAMPLE);
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (size_t s = 0; s < sample.size(); s++) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            sample[s] = v[(state >> 33) % static_cast<uint64_t>(n)];
+        }
+        ping_pong_passes(sample.data(), sample_temp.data(), static_cast<ptrdiff_t>(sample.size()), std::less<>{});
+        std::vector<T> splitters;
+        for (size_t b = 1; b < k; b++) {
+            const T& s = sample[b * OVERSAMPLE - 1];
+            if (splitters.empty() || splitters.back() < s) splitters.push_back(s);  // Duplicates would leave empty buckets
+        }
+        if (splitters.empty()) {  // (Nearly) all keys equal
+            ping_pong_passes(v.data(), temp.data(), n, std::less<>{});
+            return;
+        }
+        Classifier<T> classifier(std::move(splitters));
+        size_t buckets = classifier.buckets();
+
+        // 2. Classification: a bucket id per key and per-thread bucket counts
+        Buffer<uint8_t> ids(n);
+        std::vector<std::vector<ptrdiff_t>> counts(threads, std::vector<ptrdiff_t>(buckets, 0));
+        auto block = [&](unsigned t) {
+            return std::pair<ptrdiff_t, ptrdiff_t>{n * t / threads, n * (t + 1) / threads};
+        };
+        parallel(threads, [&](unsigned t) {
+            auto [first, last] = block(t);
+            classifier.classify(v.data() + first, last - first, ids.data() + first);
+            for (ptrdiff_t i = first; i < last; i++) counts[t][ids[i]]++;
+        });
+
+        // Output offsets: bucket-major, then thread order, so the scatter keeps input order
+        std::vector<ptrdiff_t> bucket_start(buckets + 1);
+        ptrdiff_t offset = 0;
+        for (size_t b = 0; b < buckets; b++) {
+            bucket_start[b] = offset;
+            for (unsigned t = 0; t < threads; t++) {
+                ptrdiff_t c = counts[t][b];
+                counts[t][b] = offset;
+                offset += c;
+            }
+        }
+        bucket_start[buckets] = n;
+
+        // 3. Scatter every block into its buckets in temp
+        parallel(threads, [&](unsigned t) {
+            auto [first, last] = block(t);
+            auto& out = counts[t];
+            const T* src = v.data();
+            T* dst = temp.data();
+            for (ptrdiff_t i = first; i < last; i++) dst[out[ids[i]]++] = src[i];
+        });
+
+        // 4. Local bucket sorts: copy back, then ping-pong with temp's same range as scratch
+        std::atomic<size_t> next{0};
+        parallel(threads, [&](unsigned) {
+            for (size_t b = next++; b < buckets; b = next++) {
+                ptrdiff_t first = bucket_start[b], last = bucket_start[b + 1];
+                std::copy(temp.begin() + first, temp.begin() + last, v.begin() + first);
+                ping_pong_passes(v.data() + first, temp.data() + first, last - first, std::less<>{});
+            }
+        });
+    }
+
+} // namespace cam
+
+#endif // SAMPLE_SORT_H
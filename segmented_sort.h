@@ -0,0 +1,94 @@
+#ifndef SEGMENTED_SORT_H
+#define SEGMENTED_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+#include "sample_sort.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+
+// Segmented sort: many short independent arrays stored back to back in one
+// buffer, segment s being v[offsets[s], offsets[s + 1]). Every segment is
+// sorted on its own with no per-segment allocation or call overhead:
+//   up to 16 keys    the branch-free network of exactly that size
+//   longer segments  line-sized network chunks, then the merge passes of
+//                    chunk_sort through one scratch buffer shared by the call
+// Threads take contiguous shares of the keys (whole segments each).
+namespace cam {
+
+    namespace segmented {
+
+        inline constexpr size_t NETWORK_MAX = 16;
+        inline constexpr size_t MIN_PARALLEL = 1 << 16;  // Keys per thread worth a thread
+
+        // Sorts a[0, n), n <= NETWORK_MAX, with the network of size n
+        template<class T, class Compare>
+        void sort_tiny(T* a, size_t n, Compare comp) {
+            using Kernel = void (*)(T*, Compare);
+            static constexpr auto kernels = []<size_t... N>(std::index_sequence<N...>) {
+                return std::array<Kernel, sizeof...(N)>{&static_sort<N, T, Compare>...};
+            }(std::make_index_sequence<NETWORK_MAX + 1>{});
+            kernels[n](a, comp);
+        }
+
+        // Sorts v[first, last) with line-sized network chunks and the chunk_sort merge passes
+        template<class Vec, class Compare>
+        void sort_segment(Vec& v, size_t first, size_t last, Vec& temp, Compare comp) {
+            using T = typename Vec::value_type;
+            T* a = v.data();
+            size_t n = last - first;
+            if (n <= NETWORK_MAX) {
+                sort_tiny(a + first, n, comp);
+                return;
+            }
+            constexpr size_t K = std::clamp<size_t>(64 / sizeof(T), 1, NETWORK_MAX);
+            size_t i = first;
+            for (; i + K <= last; i += K) static_sort<K>(a + i, comp);
+            sort_tiny(a + i, last - i, comp);
+            merge_passes(v, static_cast<ptrdiff_t>(first), static_cast<ptrdiff_t>(last) - 1,
+                         static_cast<ptrdiff_t>(K), temp, comp);
+        }
+
+    } // namespace segmented
+
+    // Sorts every segment v[offsets[s], offsets[s + 1]) independently; offsets is
+    // nondecreasing with offsets.size() - 1 segments. threads == 0 uses every hardware thread.
+    template<class Vec, class Offsets, class Compare = std::less<>>
+    void segmented_sort(Vec& v, const Offsets& offsets, unsigned threads = 0, Compare comp = {}) {
+        using namespace segmented;
+        if (offsets.size() < 2) return;
+        size_t segments = offsets.size() - 1;
+        size_t begin = static_cast<size_t>(offsets[0]), end = static_cast<size_t>(offsets[segments]);
+        size_t n = end - begin;
+
+        // One scratch buffer for the whole call, indexed like v, only if a segment merges through it
+        bool merges = MERGE_KERNEL == MergeKernel::branchless;
+        bool long_segments = false;
+        for (size_t s = 0; s < segments && merges && !long_segments; s++) {
+            long_segments = static_cast<size_t>(offsets[s + 1] - offsets[s]) > NETWORK_MAX;
+        }
+        Vec temp(long_segments ? end : 0);
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::clamp<size_t>(n / MIN_PARALLEL, 1, threads));
+
+        // Thread t sorts the segments starting in its share of the keys
+        samplesort::parallel(threads, [&](unsigned t) {
+            size_t from = begin + n * t / threads, to = begin + n * (t + 1) / threads;
+            auto start = [&](size_t key) {
+                return static_cast<size_t>(std::lower_bound(offsets.begin(), offsets.begin() + segments, key) - offsets.begin());
+            };
+            size_t last_segment = t + 1 == threads ? segments : start(to);
+            for (size_t s = t == 0 ? 0 : start(from); s < last_segment; s++) {
+                sort_segment(v, static_cast<size_t>(offsets[s]), static_cast<size_t>(offsets[s + 1]), temp, comp);
+            }
+        });
+    }
+
+} // namespace cam
+
+#endif // SEGMENTED_SORT_H
@@ -0,0 +1,126 @@
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+// Selection on top of the chunked kernels, for callers that only need the
+// smallest k keys or a few order statistics instead of a full chunk_sort.
+namespace cam {
+
+    namespace select {
+
+        // Ranges at or below this many base chunks are simply chunk-sorted
+        inline constexpr ptrdiff_t SMALL_CHUNKS = 8;
+
+        // Three-way partition of v[lo, hi) around pivot: returns [lt, gt) holding the keys equal to it
+        template<class Vec, class T>
+        std::pair<ptrdiff_t, ptrdiff_t> partition3(Vec& v, ptrdiff_t lo, ptrdiff_t hi, const T& pivot) {
+            auto* a = v.data();
+            ptrdiff_t lt = lo, i = lo, gt = hi;
+            while (i < gt) {
+                if (a[i] < pivot)      std::swap(a[lt++], a[i++]);
+                else if (pivot < a[i]) std::swap(a[i], a[--gt]);
+                else                   i++;
+            }
+            return {lt, gt};
+        }
+
+        // Pivot estimate for rank k within v[lo, hi): the matching order statistic of a
+        // small evenly spaced sample, which lands close to the target on any input order
+        template<class Vec>
+        typename Vec::value_type sample_pivot(const Vec& v, ptrdiff_t lo, ptrdiff_t hi, ptrdiff_t k) {
+            ptrdiff_t n = hi - lo;
+            ptrdiff_t samples = std::min<ptrdiff_t>(n, 64);
+            Buffer<typename Vec::value_type> sample(samples), temp(samples);
+            for (ptrdiff_t s = 0; s < samples; s++) sample[s] = v[lo + (2 * s + 1) * n / (2 * samples)];
+            chunk_sort(sample, temp);
+            return sample[std::min<ptrdiff_t>(samples - 1, (k - lo) * samples / n)];
+        }
+
+    } // namespace select
+
+    // Rearranges v so v[k] is the key a full sort would put there, with no larger
+    // key before it and no smaller key after it. Sampled-pivot partitioning, O(n) expected.
+    template<class Vec>
+    void nth_element(Vec& v, size_t k) {
+        ptrdiff_t lo = 0, hi = static_cast<ptrdiff_t>(v.size());
+        ptrdiff_t target = static_cast<ptrdiff_t>(k);
+        if (target >= hi) return;
+
+        ptrdiff_t small = select::SMALL_CHUNKS * std::max<ptrdiff_t>(1, CHUNK_SIZE / sizeof(typename Vec::value_type));
+        while (hi - lo > small) {
+            auto pivot = select::sample_pivot(v, lo, hi, target);
+            auto [lt, gt] = select::partition3(v, lo, hi, pivot);
+            if (target < lt)       hi = lt;
+            else if (target >= gt) lo = gt;
+            else return;  // v[target] equals the pivot
+        }
+        Vec part(v.begin() + lo, v.begin() + hi), temp(hi - lo);
+        chunk_sort(part, temp);
+        std::copy(part.begin(), part.end(), v.begin() + lo);
+    }
+
+    // Sorts the k smallest keys into v[0, k); the order of the rest is unspecified
+    template<class Vec>
+    void partial_sort(Vec& v, size_t k) {
+        k = std::min(k, v.size());
+        if (k == 0) return;
+        cam::nth_element(v, k - 1);
+        Vec temp(k);
+        chunk_sort(v, 0, static_cast<ptrdiff_t>(k) - 1, temp);
+    }
+
+    // Returns the k smallest keys of v in ascending order without modifying v.
+    // Keeps a cache-resident candidate buffer of at most 2k keys and a threshold
+    // (the k-th smallest candidate so far); base chunks whose minimum is not
+    // below the threshold are discarded after one branch-free scan.
+    template<class Vec>
+    std::vector<typename Vec::value_type> top_k(const Vec& v, size_t k) {
+        using T = typename Vec::value_type;
+        size_t n = v.size();
+        k = std::min(k, n);
+        if (k == 0) return {};
+
+        Buffer<T> candidates(std::min(n, 2 * k));
+        size_t count = std::min(n, k);
+        std::copy(v.begin(), v.begin() + count, candidates.begin());
+
+        // Shrinks the candidates to the k smallest and returns the k-th
+        auto shrink = [&] {
+            Buffer<T> view(candidates.begin(), candidates.begin() + count);
+            cam::nth_element(view, k - 1);
+            std::copy(view.begin(), view.begin() + k, candidates.begin());
+            count = k;
+            return *std::max_element(candidates.begin(), candidates.begin() + k);
+        };
+        T threshold = shrink();
+
+        size_t chunk = std::max<size_t>(1, CHUNK_SIZE / sizeof(T));
+        const T* a = v.data();
+        for (size_t i = k; i < n; i += chunk) {
+            size_t end = std::min(i + chunk, n);
+            T lowest = a[i];
+            for (size_t j = i + 1; j < end; j++) lowest = std::min(lowest, a[j]);
+            if (!(lowest < threshold)) continue;
+
+            for (size_t j = i; j < end; j++) {
+                if (a[j] < threshold) {
+                    candidates[count++] = a[j];
+                    if (count == candidates.size()) threshold = shrink();
+                }
+            }
+        }
+
+        Buffer<T> result(candidates.begin(), candidates.begin() + count);
+        cam::partial_sort(result, k);
+        return std::vector<T>(result.begin(), result.begin() + k);
+    }
+
+} // namespace cam
+
+#endif // SELECTION_H
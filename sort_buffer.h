@@ -0,0 +1,215 @@
+#ifndef SORT_BUFFER_H
+#define SORT_BUFFER_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Buffer allocation for the sort engine.
+// Buffers come back uninitialized (no zero-fill of gigabytes that are
+// overwritten at once), aligned to a cache line or a 2 MB huge page, and
+// optionally backed by transparent or explicit huge pages to cut TLB misses.
+// Freed blocks are kept in a pool so repeated sorts reuse their scratch space
+// instead of faulting in fresh pages every call.
+namespace cam {
+
+    inline constexpr size_t CACHE_LINE = 64;
+    inline constexpr size_t HUGE_PAGE  = 2 * 1024 * 1024;
+
+    enum class HugePages {
+        none,         // Regular pages
+        transparent,  // madvise(MADV_HUGEPAGE), the kernel promotes when it can
+        explicit_     // MAP_HUGETLB from the reserved pool, falls back to transparent
+    };
+
+    struct BufferOptions {
+        size_t alignment = CACHE_LINE;  // CACHE_LINE or HUGE_PAGE
+        HugePages huge = HugePages::none;
+        bool pooled = true;             // false: unmapped on release, for buffers that must not outlive their sort
+
+        bool operator==(const BufferOptions&) const = default;
+    };
+
+    class BufferPool {
+    public:
+        BufferPool() = default;
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+        ~BufferPool() { trim(); }
+
+        // Returns uninitialized storage of at least 'bytes', reusing a cached block when one fits
+        void* acquire(size_t bytes, BufferOptions opt) {
+            if (opt.huge != HugePages::none && opt.alignment < HUGE_PAGE) opt.alignment = HUGE_PAGE;
+            if (opt.alignment < CACHE_LINE) opt.alignment = CACHE_LINE;
+            bytes = round_up(bytes == 0 ? 1 : bytes, opt.huge != HugePages::none ? HUGE_PAGE : CACHE_LINE);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // Best fit among cached blocks, but never hand out more than twice the request
+            size_t best = free_.size();
+            for (size_t i = 0; i < free_.size(); i++) {
+                const Block& b = free_[i];
+                if (b.opt == opt && b.bytes >= bytes && b.bytes <= 2 * bytes &&
+                    (best == free_.size() || b.bytes < free_[best].bytes)) best = i;
+            }
+            Block block;
+            if (best < free_.size()) {
+                block = free_[best];
+                free_.erase(free_.begin() + best);
+                cached_ -= block.bytes;
+            } else {
+                block = allocate_block(bytes, opt);
+            }
+            live_[block.ptr] = block;
+            return block.ptr;
+        }
+
+        // Returns a block to the pool; the oldest cached blocks are unmapped beyond
+        // MAX_CACHED blocks or MAX_CACHED_BYTES; a block above the byte cap is unmapped at once
+        void release(void* p) {
+            if (p == nullptr) return;
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = live_.find(p);
+            if (it == live_.end()) return;
+            if (!it->second.opt.pooled || it->second.bytes > MAX_CACHED_BYTES) {  // Above the cap it would push out every other block
+                release_block(it->second);
+                live_.erase(it);
+                return;
+            }
+            free_.push_back(it->second);
+            cached_ += it->second.bytes;
+            live_.erase(it);
+            while (free_.size() > MAX_CACHED || cached_ > MAX_CACHED_BYTES) {
+                cached_ -= free_.front().bytes;
+                release_block(free_.front());
+                free_.erase(free_.begin());
+            }
+        }
+
+        // Gives every cached block back to the OS
+        void trim() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const Block& b : free_) release_block(b);
+            free_.clear();
+            cached_ = 0;
+        }
+
+        size_t cached_bytes() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return cached_;
+        }
+
+    private:
+        static constexpr size_t MAX_CACHED = 16;
+        static constexpr size_t MAX_CACHED_BYTES = size_t(1) << 30;  // Idle memory kept mapped
+
+        struct Block {
+            void* ptr = nullptr;
+            size_t bytes = 0;
+            BufferOptions opt;
+            void* base = nullptr;    // Start of the mapping when over-allocated for alignment
+            size_t mapped = 0;       // Mapping length, 0 for operator new blocks
+        };
+
+        static size_t round_up(size_t x, size_t a) { return (x + a - 1) / a * a; }
+
+        static Block allocate_block(size_t bytes, const BufferOptions& opt) {
+            Block b;
+            b.bytes = bytes;
+            b.opt = opt;
+#ifdef __linux__
+            if (opt.alignment >= 4096 || opt.huge != HugePages::none) {
+#ifdef MAP_HUGETLB
+                if (opt.huge == HugePages::explicit_) {
+                    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                    if (p != MAP_FAILED) {
+                        b.ptr = b.base = p;
+                        b.mapped = bytes;
+                        return b;
+                    }
+                }
+#endif
+                // Over-map by one alignment unit and keep the aligned middle
+                size_t length = bytes + opt.alignment;
+                void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p == MAP_FAILED) throw std::bad_alloc();
+                b.base = p;
+                b.mapped = length;
+                b.ptr = reinterpret_cast<void*>(round_up(reinterpret_cast<size_t>(p), opt.alignment));
+#ifdef MADV_HUGEPAGE
+                if (opt.huge != HugePages::none) madvise(b.ptr, bytes, MADV_HUGEPAGE);
+#endif
+                return b;
+            }
+#endif
+            b.ptr = ::operator new(bytes, std::align_val_t(opt.alignment));
+            return b;
+        }
+
+        static void release_block(const Block& b) {
+#ifdef __linux__
+            if (b.mapped) {
+                munmap(b.base, b.mapped);
+                return;
+            }
+#endif
+            ::operator delete(b.ptr, std::align_val_t(b.opt.alignment));
+        }
+
+        mutable std::mutex mutex_;
+        std::vector<Block> free_;
+        size_t cached_ = 0;  // Bytes of the blocks in free_
+        std::unordered_map<void*, Block> live_;
+    };
+
+    // Options of a buffer that goes straight back to the OS when freed
+    inline constexpr BufferOptions UNPOOLED{CACHE_LINE, HugePages::none, false};
+
+    // Process-wide pool shared by every buffer_allocator
+    inline BufferPool& buffer_pool() {
+        static BufferPool pool;
+        return pool;
+    }
+
+    // Allocator drawing from buffer_pool(). Elements are default-initialized,
+    // so a std::vector built with it does not zero-fill its storage.
+    template<class T>
+    class buffer_allocator {
+    public:
+        using value_type = T;
+
+        buffer_allocator() = default;
+        explicit buffer_allocator(BufferOptions opt) : opt_(opt) {}
+        template<class U> buffer_allocator(const buffer_allocator<U>& other) noexcept : opt_(other.options()) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(buffer_pool().acquire(n * sizeof(T), opt_)); }
+        void deallocate(T* p, size_t) noexcept { buffer_pool().release(p); }
+
+        template<class U> void construct(U* p) noexcept { ::new (static_cast<void*>(p)) U; }
+        template<class U, class... Args> void construct(U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        const BufferOptions& options() const { return opt_; }
+
+        // Every instance returns memory to the same pool
+        template<class U> bool operator==(const buffer_allocator<U>&) const noexcept { return true; }
+
+    private:
+        BufferOptions opt_;
+    };
+
+    template<class T>
+    using Buffer = std::vector<T, buffer_allocator<T>>;
+
+} // namespace cam
+
+#endif // SORT_BUFFER_H
@@ -0,0 +1,193 @@
+#ifndef STATIC_SORT_H
+#define STATIC_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include "chunk_sort.h"
+
+// Compile-time specialized chunk sort.
+// The base-chunk size, element type and comparator are template parameters,
+// so each instantiation gets a fully unrolled, branch-free base sort: optimal
+// comparator networks from constexpr tables for the sizes that have one, and
+// networks on both halves joined by an unrolled branch-free merge otherwise.
+// chunk_sort_auto picks the instantiation for CHUNK_SIZE at run time.
+namespace cam {
+
+namespace networks {
+
+using Pair = std::pair<uint8_t, uint8_t>;
+
+// Optimal-size sorting networks (all verified exhaustively with the 0-1 principle)
+template<size_t N> struct Network { static constexpr bool exists = false; };
+
+template<> struct Network<2> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 1> pairs{{{0, 1}}};
+};
+template<> struct Network<3> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 3> pairs{{{0, 2}, {0, 1}, {1, 2}}};
+};
+template<> struct Network<4> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 5> pairs{{{0, 2}, {1, 3}, {0, 1}, {2, 3}, {1, 2}}};
+};
+template<> struct Network<5> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 9> pairs{{{0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1},
+                                                {2, 4}, {1, 2}, {3, 4}, {2, 3}}};
+};
+template<> struct Network<6> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 12> pairs{{{0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3},
+                                                 {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}}};
+};
+template<> struct Network<7> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 16> pairs{{{0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5},
+                                                 {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5}, {1, 2}, {3, 4}, {5, 6}}};
+};
+template<> struct Network<8> {
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 19> pairs{{{0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+                                                 {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+                                                 {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}}};
+};
+template<> struct Network<16> {  // Green's 60-comparator network
+    static constexpr bool exists = true;
+    static constexpr std::array<Pair, 60> pairs{{
+        {0, 13}, {1, 12}, {2, 15}, {3, 14}, {4, 8}, {5, 6}, {7, 11}, {9, 10},
+        {0, 5}, {1, 7}, {2, 9}, {3, 4}, {6, 13}, {8, 14}, {10, 15}, {11, 12},
+        {0, 1}, {2, 3}, {4, 5}, {6, 8}, {7, 9}, {10, 11}, {12, 13}, {14, 15},
+        {0, 2}, {1, 3}, {4, 10}, {5, 11}, {6, 7}, {8, 9}, {12, 14}, {13, 15},
+        {1, 2}, {3, 12}, {4, 6}, {5, 7}, {8, 10}, {9, 11}, {13, 14},
+        {1, 4}, {2, 6}, {5, 8}, {7, 10}, {9, 13}, {11, 14},
+        {2, 4}, {3, 6}, {9, 12}, {11, 13},
+        {3, 5}, {6, 8}, {7, 9}, {10, 12},
+        {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12},
+        {6, 7}, {8, 9}}};
+};
+
+} // namespace networks
+
+// Branch-free compare-and-swap: selects instead of branching, so it compiles to cmov/min/max
+template<class T, class Compare>
+inline void compare_swap(T& x, T& y, Compare comp) {
+    CAM_TRACE_LOAD(&x);
+    CAM_TRACE_LOAD(&y);
+    bool swap = comp(y, x);
+    T lo = swap ? y : x;
+    T hi = swap ? x : y;
+    x = lo;
+    y = hi;
+    CAM_TRACE_STORE(&x);
+    CAM_TRACE_STORE(&y);
+}
+
+// Fully unrolled merge of the sorted halves a[0, L) and a[L, L + R).
+// Exhausted sides are handled with flags rather than branches.
+template<size_t L, size_t R, class T, class Compare>
+inline void static_merge(T* a, Compare comp) {
+    T out[L + R];
+    size_t i = 0, j = L;
+    [&]<size_t... K>(std::index_sequence<K...>) {
+        (([&] {
+            bool left_done = i >= L;
+            bool right_done = j >= L + R;
+            const T& x = a[left_done ? 0 : i];
+            const T& y = a[right_done ? L : j];
+            bool take_right = !right_done && (left_done || comp(y, x));
+            out[K] = take_right ? y : x;
+            j += take_right;
+            i += !take_right;
+        }()), ...);
+    }(std::make_index_sequence<L + R>{});
+    std::copy(out, out + L + R, a);
+}
+
+// Sorts a[0, N) with no data-dependent branches
+template<size_t N, class T, class Compare>
+inline void static_sort(T* a, Compare comp) {
+    if constexpr (N < 2) {
+        return;
+    } else if constexpr (networks::Network<N>::exists) {
+        constexpr auto& pairs = networks::Network<N>::pairs;
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (compare_swap(a[pairs[I].first], a[pairs[I].second], comp), ...);
+        }(std::make_index_sequence<pairs.size()>{});
+    } else {
+        constexpr size_t L = N / 2;
+        static_sort<L>(a, comp);
+        static_sort<N - L>(a + L, comp);
+        static_merge<L, N - L>(a, comp);
+    }
+}
+
+// Sorts every ChunkBytes-sized chunk of a[0, n) with its network and the short
+// tail chunk by insertion; returns the run length left for the merge passes
+template<size_t ChunkBytes, class T, class Compare>
+ptrdiff_t network_chunks(T* a, ptrdiff_t n, Compare comp) {
+    constexpr ptrdiff_t K = std::max<size_t>(1, ChunkBytes / sizeof(T));
+    CAM_TRACE_PHASE("chunk: base sort");
+    ptrdiff_t i = 0;
+    for (; i + K <= n; i += K) static_sort<K>(a + i, comp);
+    for (ptrdiff_t j = i + 1; j < n; j++) {  // Short tail chunk
+        T x = a[j];
+        ptrdiff_t k = j;
+        for (; k > i && comp(x, a[k - 1]); k--) a[k] = a[k - 1];
+        a[k] = x;
+    }
+    return K;
+}
+
+// Chunk sort whose base-chunk size, element type and comparator are fixed at compile time
+template<size_t ChunkBytes, class Vec, class Compare = std::less<>>
+void chunk_sort_fixed(Vec& v, Vec& temp, Compare comp = {}) {
+    ptrdiff_t n = static_cast<ptrdiff_t>(v.size());
+    ptrdiff_t run = network_chunks<ChunkBytes>(v.data(), n, comp);
+    merge_passes(v, 0, n - 1, run, temp, comp);
+}
+
+// Sorts a[0, n) through scratch[0, n): network-sorted base chunks (the chunk sizes of
+// chunk_sort_auto), then branchless merge levels ping-ponging between the two,
+// whatever MERGE_KERNEL is
+template<class T, class Compare>
+void ping_pong_passes(T* a, T* scratch, ptrdiff_t n, Compare comp) {
+    ptrdiff_t chunk;
+    switch (CHUNK_SIZE) {
+    case 32:  chunk = network_chunks<32>(a, n, comp);  break;
+    case 128: chunk = network_chunks<128>(a, n, comp); break;
+    case 256: chunk = network_chunks<256>(a, n, comp); break;
+    default:  chunk = network_chunks<64>(a, n, comp);  break;
+    }
+    T* src = a;
+    T* dst = scratch;
+    for (ptrdiff_t size = chunk; size < n; size *= 2) {
+        CAM_TRACE_PHASE("pingpong: merge run " + std::to_string(size));
+        merge_level(src, dst, 0, n, size, comp);
+        std::swap(src, dst);
+    }
+    if (src != a) std::copy(src, src + n, a);
+}
+
+// Runs the instantiation whose chunk matches CHUNK_SIZE (normally the detected
+// cache line); sizes without an instantiation use the runtime chunk_sort.
+template<class Vec>
+void chunk_sort_auto(Vec& v, Vec& temp) {
+    switch (CHUNK_SIZE) {
+    case 32:  chunk_sort_fixed<32>(v, temp);  break;
+    case 64:  chunk_sort_fixed<64>(v, temp);  break;
+    case 128: chunk_sort_fixed<128>(v, temp); break;
+    case 256: chunk_sort_fixed<256>(v, temp); break;
+    default:  chunk_sort(v, temp);            break;
+    }
+}
+
+} // namespace cam
+
+#endif // STATIC_SORT_H
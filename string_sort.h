@@ -0,0 +1,208 @@
+#ifndef STRING_SORT_H
+#define STRING_SORT_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+// LCP-aware merge sort for variable-length string keys.
+// Same bottom-up structure as chunk_sort: small chunks are sorted directly,
+// then runs are merged pairwise. Every item carries the length of its longest
+// common prefix (LCP) with its predecessor in the run, so a merge can decide
+// most comparisons from two LCP values alone and never rescans a prefix it
+// already knows is equal. Each item also caches, inline and big-endian, the 8
+// key bytes that start at its LCP (the first 8 bytes for a run head). Those are
+// exactly the bytes the next comparison needs, so comparisons rarely
+// dereference a string, even for keys like URLs with long shared prefixes.
+namespace cam {
+
+    // Owns the characters of many strings in large blocks; views stay valid
+    // for the arena's lifetime because blocks never move.
+    class StringArena {
+    public:
+        explicit StringArena(size_t block_size = 1 << 20) : block_size_(block_size) {}
+
+        std::string_view add(std::string_view s) {
+            if (blocks_.empty() || used_ + s.size() > capacity_) {
+                capacity_ = std::max(block_size_, s.size());
+                blocks_.push_back(std::make_unique<char[]>(capacity_));
+                used_ = 0;
+            }
+            char* dst = blocks_.back().get() + used_;
+            if (!s.empty()) std::memcpy(dst, s.data(), s.size());
+            used_ += s.size();
+            return {dst, s.size()};
+        }
+
+    private:
+        size_t block_size_;
+        size_t capacity_ = 0;
+        size_t used_ = 0;
+        std::vector<std::unique_ptr<char[]>> blocks_;
+    };
+
+    namespace strings {
+
+        struct Item {
+            std::string_view s;
+            uint64_t cache;   // Key bytes [lcp, lcp + 8), big-endian, zero padded
+            uint32_t lcp;     // LCP with the previous item of the run
+        };
+
+        inline uint64_t load_big_endian(const char* p) {
+            uint64_t w;
+            std::memcpy(&w, p, 8);
+            if constexpr (std::endian::native == std::endian::little) {
+#ifdef _MSC_VER
+                w = _byteswap_uint64(w);
+#else
+                w = __builtin_bswap64(w);
+#endif
+            }
+            return w;
+        }
+
+        inline uint64_t load_cache(std::string_view s, size_t offset) {
+            if (offset + 8 <= s.size()) return load_big_endian(s.data() + offset);
+            unsigned char bytes[8] = {};
+            if (offset < s.size()) std::memcpy(bytes, s.data() + offset, std::min<size_t>(8, s.size() - offset));
+            uint64_t p = 0;
+            for (int i = 0; i < 8; i++) p = (p << 8) | bytes[i];
+            return p;
+        }
+
+        struct Order {
+            bool a_first;  // a <= b
+            uint32_t lcp;  // LCP(a, b)
+        };
+
+        // Compares a and b whose first h bytes are known to be equal, dereferencing
+        // the strings only past h + 8
+        inline Order compare_from(uint64_t a_cache, const Item& a, uint64_t b_cache, const Item& b, uint32_t h) {
+            uint32_t limit = static_cast<uint32_t>(std::min(a.s.size(), b.s.size()));
+            if (a_cache != b_cache) {
+                uint32_t lcp = std::min<uint32_t>(h + std::countl_zero(a_cache ^ b_cache) / 8, limit);
+                return {a_cache < b_cache, lcp};
+            }
+            h = std::min(h + 8, std::max(h, limit));
+
+            // Scan the rest a word at a time; the cache words are big-endian, so
+            // the first differing byte is the most significant differing one
+            while (h + 8 <= limit) {
+                uint64_t wa = load_big_endian(a.s.data() + h), wb = load_big_endian(b.s.data() + h);
+                if (wa != wb) {
+                    return {wa < wb, h + static_cast<uint32_t>(std::countl_zero(wa ^ wb)) / 8};
+                }
+                h += 8;
+            }
+            while (h < limit && a.s[h] == b.s[h]) h++;
+            if (h < limit) return {static_cast<unsigned char>(a.s[h]) < static_cast<unsigned char>(b.s[h]), h};
+            return {a.s.size() <= b.s.size(), h};
+        }
+
+        // Full comparison of two items whose caches hold their first 8 bytes
+        inline Order compare(const Item& a, const Item& b) {
+            return compare_from(load_cache(a.s, 0), a, load_cache(b.s, 0), b, 0);
+        }
+
+        // Insertion sort of a small chunk, then its LCP array and caches
+        inline void sort_chunk(Item* items, size_t n) {
+            for (size_t i = 1; i < n; i++) {
+                Item x = items[i];
+                size_t j = i;
+                while (j > 0 && !compare(items[j - 1], x).a_first) {
+                    items[j] = items[j - 1];
+                    j--;
+                }
+                items[j] = x;
+            }
+            for (size_t i = 0; i < n; i++) {
+                items[i].lcp = i ? compare(items[i - 1], items[i]).lcp : 0;
+                items[i].cache = load_cache(items[i].s, items[i].lcp);
+            }
+        }
+
+        // Stable merge of runs a and b into out, using and producing LCP arrays.
+        // Invariant: each head's cache holds its bytes at la (resp. lb).
+        inline void lcp_merge(const Item* a, size_t na, const Item* b, size_t nb, Item* out) {
+            size_t i = 0, j = 0, k = 0;
+            uint32_t la = 0, lb = 0;  // LCP of each head with the last item written
+            uint64_t ca = na ? a[0].cache : 0, cb = nb ? b[0].cache : 0;
+            while (i < na && j < nb) {
+                if (la > lb) {
+                    out[k] = a[i++]; out[k].lcp = la; out[k++].cache = ca;
+                    if (i < na) { la = a[i].lcp; ca = a[i].cache; }
+                } else if (la < lb) {
+                    out[k] = b[j++]; out[k].lcp = lb; out[k++].cache = cb;
+                    if (j < nb) { lb = b[j].lcp; cb = b[j].cache; }
+                } else {
+                    Order o = compare_from(ca, a[i], cb, b[j], la);
+                    if (o.a_first) {
+                        out[k] = a[i++]; out[k].lcp = la; out[k++].cache = ca;
+                        if (i < na) { la = a[i].lcp; ca = a[i].cache; }
+                        lb = o.lcp; cb = load_cache(b[j].s, lb);
+                    } else {
+                        out[k] = b[j++]; out[k].lcp = lb; out[k++].cache = cb;
+                        if (j < nb) { lb = b[j].lcp; cb = b[j].cache; }
+                        la = o.lcp; ca = load_cache(a[i].s, la);
+                    }
+                }
+            }
+            if (i < na) {
+                out[k] = a[i++]; out[k].lcp = la; out[k++].cache = ca;
+                while (i < na) out[k++] = a[i++];
+            }
+            if (j < nb) {
+                out[k] = b[j++]; out[k].lcp = lb; out[k++].cache = cb;
+                while (j < nb) out[k++] = b[j++];
+            }
+        }
+
+    } // namespace strings
+
+    // Sorts string views (typically over one StringArena) in byte-wise order.
+    // Stable. If lcp_out is given it receives LCP(v[i-1], v[i]) for every i (0 for i == 0).
+    inline void string_sort(std::vector<std::string_view>& v, std::vector<uint32_t>* lcp_out = nullptr) {
+        using strings::Item;
+        size_t n = v.size();
+        Buffer<Item> items(n), temp(n);
+        for (size_t i = 0; i < n; i++) items[i] = {v[i], 0, 0};
+
+        size_t chunk_size = std::max<size_t>(4, CHUNK_SIZE / 4);  // Items are 32 bytes, keep chunks in a few lines
+        for (size_t i = 0; i < n; i += chunk_size) {
+            strings::sort_chunk(&items[i], std::min(chunk_size, n - i));
+        }
+
+        // Bottom-up merge passes, ping-ponging between items and temp
+        Item* src = items.data();
+        Item* dst = temp.data();
+        for (size_t size = chunk_size; size < n; size *= 2) {
+            for (size_t i = 0; i < n; i += 2 * size) {
+                size_t mid = std::min(i + size, n);
+                size_t right_end = std::min(i + 2 * size, n);
+                strings::lcp_merge(src + i, mid - i, src + mid, right_end - mid, dst + i);
+            }
+            std::swap(src, dst);
+        }
+
+        for (size_t i = 0; i < n; i++) v[i] = src[i].s;
+        if (lcp_out) {
+            lcp_out->resize(n);
+            for (size_t i = 0; i < n; i++) (*lcp_out)[i] = src[i].lcp;
+        }
+    }
+
+} // namespace cam
+
+#endif // STRING_SORT_H
@@ -0,0 +1,571 @@
+// Checks the sort engine against std::sort: every output must be sorted and a
+// permutation of the input. Sizes straddle the base-chunk and merge-level
+// boundaries, where the ptrdiff_t index arithmetic has its edge cases.
+// "--large" adds one sort of more than 2^31 one-byte keys (over 4 GB with temp),
+// so indices that would wrap in 32 bits are exercised; it is opt-in (CAM_LARGE_TESTS).
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "argsort.h"
+#include "chunk_sort.h"
+#include "float_sort.h"
+#include "mem_planner.h"
+#include "multiway_merge.h"
+#include "registry.h"
+#include "resort.h"
+#include "segmented_sort.h"
+#include "selection.h"
+#include "sort_buffer.h"
+#include "static_sort.h"
+#include "string_sort.h"
+#include "unique_sort.h"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (ok) return;
+        std::printf("FAILED: %s\n", what.c_str());
+        failures++;
+    }
+
+    // Sizes around every multiple of the chunk (in keys) and every merge run length
+    std::vector<size_t> boundary_sizes(size_t chunk_keys, size_t max) {
+        std::vector<size_t> sizes{0, 1, 2, 3};
+        for (size_t base : {chunk_keys, 3 * chunk_keys}) {
+            for (size_t run = base; run <= max; run *= 2) {
+                for (size_t n : {run - 1, run, run + 1}) sizes.push_back(n);
+            }
+        }
+        std::sort(sizes.begin(), sizes.end());
+        sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+        return sizes;
+    }
+
+    template<class Sort>
+    void check_sort(const char* name, size_t n, uint32_t key_max, Sort sort) {
+        std::mt19937 rng(static_cast<uint32_t>(n) * 2654435761u);
+        std::uniform_int_distribution<uint32_t> dist(0, key_max);
+        cam::Buffer<int> v(n), temp(n);
+        for (auto& x : v) x = static_cast<int>(dist(rng));
+        std::vector<int> expected(v.begin(), v.end());
+        std::sort(expected.begin(), expected.end());
+        sort(v, temp);
+        check(std::equal(v.begin(), v.end(), expected.begin(), expected.end()),
+              std::string(name) + " n=" + std::to_string(n) + " chunk=" + std::to_string(cam::CHUNK_SIZE) +
+              (cam::MERGE_KERNEL == cam::MergeKernel::branchless ? " branchless" : " gap"));
+    }
+
+    void boundary_tests() {
+        for (size_t chunk : {32, 64, 100, 128}) {  // 100: the runtime (non-network) chunk path
+            cam::CHUNK_SIZE = chunk;
+            for (auto kernel : {cam::MergeKernel::gap, cam::MergeKernel::branchless}) {
+                cam::MERGE_KERNEL = kernel;
+                for (size_t n : boundary_sizes(chunk / sizeof(int), 1 << 14)) {
+                    for (uint32_t key_max : {7u, 1u << 30}) {  // Many duplicates, mostly distinct
+                        check_sort("chunk_sort", n, key_max, [](auto& v, auto& temp) { cam::chunk_sort(v, temp); });
+                        check_sort("chunk_sort_auto", n, key_max, [](auto& v, auto& temp) { cam::chunk_sort_auto(v, temp); });
+                        check_sort("merge_sort", n, key_max, [](auto& v, auto& temp) {
+                            cam::merge_sort(v, 0, static_cast<ptrdiff_t>(v.size()) - 1, temp);
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    // Total order of float_sort: -0 before +0, NaNs placed as asked, bit patterns preserved
+    template<class F>
+    void float_tests() {
+        using L = std::numeric_limits<F>;
+        const F specials[] = {F(-0.0), F(0.0), L::infinity(), -L::infinity(), L::quiet_NaN(), -L::quiet_NaN(),
+                              L::denorm_min(), -L::denorm_min(), L::max(), L::lowest(), F(1), F(-1)};
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> dist(-1e6, 1e6);
+        for (size_t n : {0, 1, 2, 12, 15, 16, 17, 100, 1000}) {
+            for (auto nans : {cam::NanPlacement::last, cam::NanPlacement::first, cam::NanPlacement::ieee}) {
+                std::vector<F> v;
+                for (size_t i = 0; i < n; i++) v.push_back(i % 3 == 0 ? specials[(i / 3) % std::size(specials)] : F(dist(rng)));
+                auto bits = [](const std::vector<F>& x) {
+                    std::vector<cam::ordered_bits_t<F>> b;
+                    for (F f : x) b.push_back(cam::to_ordered_bits(f));
+                    return b;
+                };
+                auto before = bits(v);
+                cam::float_sort(v, nans);
+                auto after = bits(v);
+                std::string what = "float_sort<" + std::to_string(sizeof(F)) + "> n=" + std::to_string(n) +
+                                   " nans=" + std::to_string(int(nans));
+                std::sort(before.begin(), before.end());
+                auto sorted_after = after;
+                std::sort(sorted_after.begin(), sorted_after.end());
+                check(before == sorted_after, what + ": permutation of bit patterns");
+
+                // Without the NaNs every placement is the total order
+                std::vector<cam::ordered_bits_t<F>> numbers;
+                size_t first_number = v.size(), last_number = 0;
+                for (size_t i = 0; i < v.size(); i++) {
+                    if (std::isnan(v[i])) continue;
+                    numbers.push_back(after[i]);
+                    first_number = std::min(first_number, i);
+                    last_number = i + 1;
+                }
+                check(std::is_sorted(numbers.begin(), numbers.end()), what + ": total order");
+                if (nans == cam::NanPlacement::ieee) check(std::is_sorted(after.begin(), after.end()), what + ": IEEE order");
+                if (nans == cam::NanPlacement::last) check(last_number == numbers.size(), what + ": NaNs last");
+                if (nans == cam::NanPlacement::first) check(numbers.empty() || first_number == v.size() - numbers.size(), what + ": NaNs first");
+            }
+        }
+    }
+
+    // string_sort against std::stable_sort: equal strings keep input order (same
+    // storage), and the LCP array matches. Long shared prefixes and prefix-of-another keys.
+    void string_tests() {
+        std::mt19937 rng(11);
+        for (size_t n : {0, 1, 2, 3, 4, 5, 31, 32, 33, 1000}) {
+            std::vector<std::string> storage;
+            for (size_t i = 0; i < n; i++) {
+                std::string s = (rng() % 2 ? "https://example.com/" : "");
+                size_t len = rng() % 12;
+                for (size_t j = 0; j < len; j++) s += static_cast<char>('a' + rng() % 3);
+                storage.push_back(s);
+            }
+            std::vector<std::string_view> v(storage.begin(), storage.end());
+            auto expected = v;
+            std::stable_sort(expected.begin(), expected.end());
+            std::vector<uint32_t> lcp;
+            cam::string_sort(v, &lcp);
+
+            std::string what = "string_sort n=" + std::to_string(n);
+            bool same = v.size() == expected.size();
+            for (size_t i = 0; same && i < v.size(); i++) same = v[i].data() == expected[i].data();
+            check(same, what + ": sorted and stable");
+            bool lcp_ok = lcp.size() == n;
+            for (size_t i = 0; lcp_ok && i < n; i++) {
+                uint32_t want = 0;
+                if (i > 0) {
+                    auto [a, b] = std::mismatch(v[i - 1].begin(), v[i - 1].end(), v[i].begin(), v[i].end());
+                    want = static_cast<uint32_t>(a - v[i - 1].begin());
+                }
+                lcp_ok = lcp[i] == want;
+            }
+            check(lcp_ok, what + ": LCP array");
+        }
+    }
+
+    // nth_element, partial_sort and top_k against a full sort, for every k at the
+    // ends and around the chunk boundaries; top_k must leave its input untouched
+    void selection_tests() {
+        for (size_t n : {0, 1, 2, 15, 16, 17, 255, 256, 257, 5000}) {
+            for (uint32_t key_max : {7u, 1u << 30}) {
+                std::mt19937 rng(static_cast<uint32_t>(n) + key_max);
+                std::uniform_int_distribution<uint32_t> dist(0, key_max);
+                cam::Buffer<int> input(n);
+                for (auto& x : input) x = static_cast<int>(dist(rng));
+                std::vector<int> sorted(input.begin(), input.end());
+                std::sort(sorted.begin(), sorted.end());
+
+                for (size_t k : {size_t(0), size_t(1), n / 2, n > 0 ? n - 1 : 0, n, n + 1}) {
+                    std::string what = " n=" + std::to_string(n) + " k=" + std::to_string(k);
+                    if (k < n) {
+                        cam::Buffer<int> v(input.begin(), input.end());
+                        cam::nth_element(v, k);
+                        bool ok = v[k] == sorted[k];
+                        for (size_t i = 0; ok && i < n; i++) ok = i < k ? v[i] <= v[k] : v[i] >= v[k];
+                        check(ok && std::is_permutation(v.begin(), v.end(), sorted.begin()), "nth_element" + what);
+                    }
+                    cam::Buffer<int> p(input.begin(), input.end());
+                    cam::partial_sort(p, k);
+                    size_t m = std::min(k, n);
+                    check(std::equal(p.begin(), p.begin() + m, sorted.begin()) &&
+                          std::is_permutation(p.begin(), p.end(), sorted.begin()), "partial_sort" + what);
+                    cam::Buffer<int> untouched(input.begin(), input.end());
+                    auto top = cam::top_k(untouched, k);
+                    check(std::equal(top.begin(), top.end(), sorted.begin(), sorted.begin() + m), "top_k" + what);
+                    check(std::equal(untouched.begin(), untouched.end(), input.begin(), input.end()), "top_k input" + what);
+                }
+            }
+        }
+    }
+
+    // Key plus where it came from; compares by key only, so stability is observable
+    struct Tagged {
+        int key;
+        uint32_t origin;
+        bool operator<(const Tagged& o) const { return key < o.key; }
+        bool operator==(const Tagged& o) const { return key == o.key && origin == o.origin; }
+    };
+
+    // merge_sorted against std::stable_sort of the concatenated shards: no shards,
+    // one shard, empty shards, skewed shards (galloping) and the threaded split
+    void merge_tests() {
+        struct Case { const char* name; std::vector<size_t> sizes; uint32_t key_max; unsigned threads; };
+        const Case cases[] = {
+            {"none", {}, 7, 1},
+            {"single", {1000}, 7, 1},
+            {"empty shards", {0, 500, 0, 0, 300, 0}, 7, 1},
+            {"all empty", {0, 0, 0}, 7, 1},
+            {"skewed", {1, 20000, 3, 5000}, 1u << 30, 1},
+            {"many shards", std::vector<size_t>(100, 37), 7, 1},
+            {"threaded", {100000, 70000, 0, 130001}, 7, 4},
+            {"threaded distinct", {100000, 70000, 130001}, 1u << 30, 4},
+        };
+        for (const auto& c : cases) {
+            std::mt19937 rng(static_cast<uint32_t>(c.sizes.size()) + c.key_max);
+            std::uniform_int_distribution<uint32_t> dist(0, c.key_max);
+            std::vector<std::vector<Tagged>> data;
+            std::vector<Tagged> expected;
+            uint32_t origin = 0;
+            for (size_t size : c.sizes) {
+                std::vector<Tagged> shard(size);
+                for (auto& t : shard) t.key = static_cast<int>(dist(rng));
+                std::sort(shard.begin(), shard.end());
+                for (auto& t : shard) t.origin = origin++;  // Increasing along shard order and within a shard
+                expected.insert(expected.end(), shard.begin(), shard.end());
+                data.push_back(std::move(shard));
+            }
+            std::stable_sort(expected.begin(), expected.end());
+            std::vector<std::span<const Tagged>> shards(data.begin(), data.end());
+            std::vector<Tagged> out(expected.size());
+            cam::merge_sorted<Tagged>(shards, out, c.threads);
+            check(out == expected, std::string("merge_sorted ") + c.name + ": sorted and stable");
+        }
+
+        std::vector<int> a{1, 2}, out(1);
+        bool threw = false;
+        try {
+            cam::merge_sorted<int>({std::span<const int>(a)}, out);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        check(threw, "merge_sorted: output size mismatch throws");
+    }
+
+    // Each budget reaches one strategy: plan_sort must pick it, and sort_within_budget
+    // and sort_file_within_budget must sort with it. Keys alone over the budget make
+    // the in-memory sort fall back to the block merge and report that it does not fit.
+    void planner_tests() {
+        using cam::SortStrategy;
+        const size_t n = 100000;  // 400 KB of keys
+        struct Case { size_t budget; SortStrategy strategy; };
+        const Case cases[] = {
+            {1 << 20, SortStrategy::ping_pong},      // keys + full temp: 800 KB
+            {500 << 10, SortStrategy::block_merge},  // keys + sqrt(n) buffer: about 404 KB
+            {64 << 10, SortStrategy::external},      // several runs, more than one merge pass
+        };
+        std::mt19937 rng(13);
+        std::vector<int> input(n);
+        for (auto& x : input) x = static_cast<int>(rng() >> 1);
+        std::vector<int> sorted = input;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto dir = std::filesystem::temp_directory_path();
+        auto in_path = dir / ("cam_sort_test_in_" + std::to_string(rng()));
+        auto out_path = dir / ("cam_sort_test_out_" + std::to_string(rng()));
+        {
+            std::ofstream out(in_path, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(input.data()), n * sizeof(int));
+        }
+
+        for (const auto& c : cases) {
+            std::string what = std::string(" ") + cam::strategy_name(c.strategy);
+            auto plan = cam::plan_sort<int>(n, c.budget);
+            check(plan.strategy == c.strategy, "plan_sort" + what);
+            check(plan.fits == (plan.peak_bytes <= c.budget), "plan_sort fits" + what);
+
+            cam::Buffer<int> v(input.begin(), input.end());
+            auto used = cam::sort_within_budget(v, c.budget);
+            SortStrategy in_memory = c.strategy == SortStrategy::external ? SortStrategy::block_merge : c.strategy;
+            check(used.strategy == in_memory && used.fits == (c.strategy != SortStrategy::external),
+                  "sort_within_budget strategy" + what);
+            check(std::equal(v.begin(), v.end(), sorted.begin(), sorted.end()), "sort_within_budget sorted" + what);
+
+            auto file_plan = cam::sort_file_within_budget<int>(in_path, out_path, c.budget);
+            std::vector<int> result(n + 1);
+            std::ifstream in(out_path, std::ios::binary);
+            in.read(reinterpret_cast<char*>(result.data()), (n + 1) * sizeof(int));
+            result.resize(static_cast<size_t>(in.gcount()) / sizeof(int));
+            check(file_plan.strategy == c.strategy, "sort_file_within_budget strategy" + what);
+            check(result == sorted, "sort_file_within_budget sorted" + what);
+        }
+        std::filesystem::remove(in_path);
+        std::filesystem::remove(out_path);
+    }
+
+    // Indices 0..n-1 stably ordered by less
+    template<class Vec, class Less>
+    std::vector<size_t> stable_indices(const Vec& keys, Less less) {
+        std::vector<size_t> idx(keys.size());
+        for (size_t i = 0; i < idx.size(); i++) idx[i] = i;
+        std::stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return less(keys[a], keys[b]); });
+        return idx;
+    }
+
+    // Packed argsort for 4- and 8-byte integers and doubles (total order, -0 before +0)
+    // is always stable; the comparator argsort is stable on request and a sorted permutation otherwise
+    template<class K>
+    void argsort_tests(const char* type) {
+        for (size_t n : {0, 1, 2, 15, 16, 17, 1000}) {
+            for (uint32_t key_max : {3u, 1u << 30}) {
+                std::mt19937 rng(static_cast<uint32_t>(n) + key_max);
+                std::uniform_int_distribution<uint32_t> dist(0, key_max);
+                cam::Buffer<K> keys(n);
+                for (auto& k : keys) k = static_cast<K>(static_cast<int64_t>(dist(rng)) - key_max / 2);
+                if constexpr (std::is_floating_point_v<K>) {
+                    for (size_t i = 0; i < n; i += 5) keys[i] = (i / 5) % 2 ? K(0.0) : K(-0.0);
+                }
+                auto by_bits = [](K a, K b) {
+                    if constexpr (std::is_floating_point_v<K>) return cam::to_ordered_bits(a) < cam::to_ordered_bits(b);
+                    else return a < b;
+                };
+                std::string what = std::string(" ") + type + " n=" + std::to_string(n) + " key_max=" + std::to_string(key_max);
+
+                auto expected = stable_indices(keys, by_bits);
+                auto idx = cam::argsort(keys);
+                check(std::equal(idx.begin(), idx.end(), expected.begin(), expected.end()), "argsort" + what);
+
+                auto stable = cam::argsort(keys, std::less<>{}, true);
+                auto by_less = stable_indices(keys, std::less<>{});
+                check(std::equal(stable.begin(), stable.end(), by_less.begin(), by_less.end()), "argsort stable comparator" + what);
+
+                auto fast = cam::argsort(keys, std::less<>{});
+                bool ok = std::is_permutation(fast.begin(), fast.end(), expected.begin(), expected.end());
+                for (size_t i = 1; ok && i < n; i++) ok = !(keys[fast[i]] < keys[fast[i - 1]]);
+                check(ok, "argsort comparator" + what);
+            }
+        }
+    }
+
+    // sort_unique and sort_counts against a std::map histogram, from all-equal to all-distinct keys
+    void unique_tests() {
+        for (size_t chunk : {32, 64, 100}) {
+            cam::CHUNK_SIZE = chunk;
+            for (size_t n : boundary_sizes(chunk / sizeof(int), 1 << 12)) {
+                for (uint32_t key_max : {0u, 7u, 1u << 30}) {
+                    std::mt19937 rng(static_cast<uint32_t>(n) + key_max);
+                    std::uniform_int_distribution<uint32_t> dist(0, key_max);
+                    cam::Buffer<int> input(n);
+                    for (auto& x : input) x = static_cast<int>(dist(rng));
+                    std::map<int, size_t> histogram;
+                    for (int x : input) histogram[x]++;
+                    std::vector<int> keys;
+                    std::vector<size_t> counts;
+                    for (auto [k, c] : histogram) keys.push_back(k), counts.push_back(c);
+                    std::string what = " n=" + std::to_string(n) + " key_max=" + std::to_string(key_max) +
+                                       " chunk=" + std::to_string(chunk);
+
+                    cam::Buffer<int> u = input;
+                    size_t unique = cam::sort_unique(u);
+                    check(unique == keys.size() && std::equal(u.begin(), u.end(), keys.begin(), keys.end()), "sort_unique" + what);
+
+                    cam::Buffer<int> c = input;
+                    std::vector<size_t> got;
+                    unique = cam::sort_counts(c, got);
+                    check(unique == keys.size() && std::equal(c.begin(), c.end(), keys.begin(), keys.end()) && got == counts,
+                          "sort_counts" + what);
+                }
+            }
+        }
+    }
+
+    // resort after random updates inside dirty ranges: given ranges (overlapping, unordered,
+    // empty, at both ends, the whole array) and auto-detected ones must both restore the order
+    void resort_tests() {
+        for (size_t n : {0, 1, 2, 17, 1000, 5000}) {
+            for (uint32_t key_max : {7u, 1u << 30}) {
+                std::mt19937 rng(static_cast<uint32_t>(n) + key_max);
+                std::uniform_int_distribution<uint32_t> dist(0, key_max);
+                cam::Buffer<int> base(n);
+                for (auto& x : base) x = static_cast<int>(dist(rng));
+                std::sort(base.begin(), base.end());
+
+                std::vector<std::vector<cam::DirtyRange>> range_sets{
+                    {},
+                    {{0, n}},
+                    {{n / 2, n / 2}},
+                    {{0, std::min<size_t>(n, 3)}, {n - std::min<size_t>(n, 3), n}},
+                    {{n * 3 / 4, n * 7 / 8}, {n / 10, n / 5}, {n / 8, n / 4}},
+                };
+                for (size_t set = 0; set < range_sets.size(); set++) {
+                    const auto& ranges = range_sets[set];
+                    cam::Buffer<int> v = base;
+                    for (const auto& r : ranges) {
+                        for (size_t i = r.first; i < r.last; i++) v[i] = static_cast<int>(dist(rng));
+                    }
+                    std::vector<int> expected(v.begin(), v.end());
+                    std::sort(expected.begin(), expected.end());
+                    std::string what = " n=" + std::to_string(n) + " key_max=" + std::to_string(key_max) +
+                                       " ranges=" + std::to_string(set);
+
+                    cam::Buffer<int> given = v;
+                    cam::resort(given, ranges);
+                    check(std::equal(given.begin(), given.end(), expected.begin(), expected.end()), "resort ranges" + what);
+
+                    cam::Buffer<int> detected = v;
+                    size_t pulled = cam::resort(detected);
+                    check(std::equal(detected.begin(), detected.end(), expected.begin(), expected.end()), "resort auto" + what);
+                    if (ranges.empty()) check(pulled == 0, "resort auto of sorted keys pulls none" + what);
+                }
+
+                cam::Buffer<int> reversed = base;
+                std::reverse(reversed.begin(), reversed.end());
+                cam::resort(reversed);
+                check(std::equal(reversed.begin(), reversed.end(), base.begin(), base.end()),
+                      "resort auto reversed n=" + std::to_string(n));
+            }
+        }
+    }
+
+    // segmented_sort against std::sort per segment: empty segments, every network size,
+    // the first merged size, long segments, keys outside [offsets[0], offsets.back()) left alone,
+    // and the threaded split over many segments
+    void segmented_tests() {
+        std::vector<size_t> lengths;
+        for (size_t len = 0; len <= 18; len++) lengths.push_back(len);
+        for (size_t len : {0, 0, 31, 32, 33, 1000, 1, 0}) lengths.push_back(len);
+        std::vector<size_t> many(30000);
+        std::mt19937 rng(17);
+        for (auto& len : many) len = rng() % 12;
+
+        for (auto kernel : {cam::MergeKernel::gap, cam::MergeKernel::branchless}) {
+            cam::MERGE_KERNEL = kernel;
+            for (const auto* lens : {&lengths, &many}) {
+                for (unsigned threads : {1u, 4u}) {
+                    const size_t lead = 5, tail = 3;  // Keys before the first and after the last segment
+                    std::vector<size_t> offsets{lead};
+                    for (size_t len : *lens) offsets.push_back(offsets.back() + len);
+                    cam::Buffer<int> v(offsets.back() + tail);
+                    for (auto& x : v) x = static_cast<int>(rng() % 100);
+                    std::vector<int> expected(v.begin(), v.end());
+                    for (size_t s = 0; s + 1 < offsets.size(); s++) {
+                        std::sort(expected.begin() + offsets[s], expected.begin() + offsets[s + 1]);
+                    }
+                    cam::segmented_sort(v, offsets, threads);
+                    check(std::equal(v.begin(), v.end(), expected.begin(), expected.end()),
+                          "segmented_sort segments=" + std::to_string(lens->size()) + " threads=" + std::to_string(threads) +
+                          (kernel == cam::MergeKernel::branchless ? " branchless" : " gap"));
+                }
+            }
+        }
+
+        cam::Buffer<int> v{3, 1, 2};
+        cam::segmented_sort(v, std::vector<size_t>{});
+        cam::segmented_sort(v, std::vector<size_t>{1});
+        check(v[0] == 3 && v[1] == 1 && v[2] == 2, "segmented_sort without segments leaves keys alone");
+    }
+
+    // Auto dispatch: each input shape must reach its engine through profile and choose_engine,
+    // and auto_sort must report that engine and sort with it, with and without a full temp
+    void dispatch_tests() {
+        const size_t n = 100000;
+        std::mt19937 rng(19);
+        auto wide = [&] { return static_cast<int>(rng() >> 2); };
+        struct Case { const char* shape; cam::Buffer<int> keys; const char* with_temp; const char* without_temp; };
+        std::vector<Case> cases;
+
+        cam::Buffer<int> small(n);
+        for (auto& x : small) x = static_cast<int>(rng() % 256);
+        cases.push_back({"small range", small, "counting", "counting"});
+
+        cam::Buffer<int> presorted(n);
+        for (auto& x : presorted) x = wide();
+        std::sort(presorted.begin(), presorted.end());
+        for (size_t i = 0; i < n; i += 1000) presorted[i] = wide();
+        cases.push_back({"presorted", presorted, "resort", "resort"});
+
+        cam::Buffer<int> reversed = presorted;
+        std::sort(reversed.begin(), reversed.end(), std::greater<>{});
+        cases.push_back({"reversed", reversed, "resort", "resort"});
+
+        cam::Buffer<int> few(n);
+        for (auto& x : few) x = static_cast<int>(rng() % 16) << 26;
+        cases.push_back({"few distinct", few, "counts", "counts"});
+
+        cam::Buffer<int> general(n);
+        for (auto& x : general) x = wide();
+        cases.push_back({"general", general, "pingpong", "blocksort"});
+
+        for (auto& c : cases) {
+            std::vector<int> expected(c.keys.begin(), c.keys.end());
+            std::sort(expected.begin(), expected.end());
+            auto p = cam::profile(c.keys);
+            for (bool full_temp : {true, false}) {
+                std::string want = full_temp ? c.with_temp : c.without_temp;
+                std::string what = std::string(" ") + c.shape + (full_temp ? " with temp" : " without temp");
+                check(cam::choose_engine<cam::Buffer<int>>(p, full_temp) == want, "choose_engine" + what);
+
+                cam::Buffer<int> v = c.keys, temp(full_temp ? n : 0);
+                check(cam::auto_sort(v, temp) == want, "auto_sort engine" + what);
+                check(std::equal(v.begin(), v.end(), expected.begin(), expected.end()), "auto_sort sorted" + what);
+            }
+        }
+
+        // Large general inputs go parallel only with several threads and a full temp
+        cam::InputProfile large;
+        large.keys = cam::registry::PARALLEL_KEYS;
+        std::string parallel = std::thread::hardware_concurrency() > 1 ? "samplesort" : "pingpong";
+        check(cam::choose_engine<cam::Buffer<int>>(large, true) == parallel, "choose_engine large with temp");
+        check(cam::choose_engine<cam::Buffer<int>>(large, false) == std::string("blocksort"), "choose_engine large without temp");
+        // Few distinct non-integer keys have no counts engine
+        cam::InputProfile few_doubles;
+        few_doubles.distinct = 0.01;
+        check(cam::choose_engine<cam::Buffer<double>>(few_doubles, true) == std::string("pingpong"), "choose_engine few distinct doubles");
+    }
+
+    // 2^31 + 2^20 + 1 byte keys: indices, run lengths and level sizes pass 2^31.
+    // Byte keys keep the permutation check to a 256-entry histogram.
+    void large_test() {
+        const size_t n = (size_t(1) << 31) + (size_t(1) << 20) + 1;
+        cam::CHUNK_SIZE = 64;
+        cam::MERGE_KERNEL = cam::MergeKernel::branchless;
+        cam::Buffer<uint8_t> v(n), temp(n);
+        std::vector<size_t> before(256, 0), after(256, 0);
+        uint64_t x = 0x9E3779B97F4A7C15ull;
+        for (auto& k : v) {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            k = static_cast<uint8_t>(x >> 56);
+            before[k]++;
+        }
+        cam::chunk_sort_auto(v, temp);
+        for (uint8_t k : v) after[k]++;
+        check(std::is_sorted(v.begin(), v.end()), "large: sorted");
+        check(before == after, "large: permutation");
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    boundary_tests();
+    float_tests<float>();
+    float_tests<double>();
+    string_tests();
+    selection_tests();
+    merge_tests();
+    planner_tests();
+    argsort_tests<int>("int");
+    argsort_tests<int64_t>("int64_t");
+    argsort_tests<double>("double");
+    unique_tests();
+    resort_tests();
+    segmented_tests();
+    dispatch_tests();
+    if (argc > 1 && std::string(argv[1]) == "--large") large_test();
+    if (failures) return 1;
+    std::printf("All sort checks passed\n");
+    return 0;
+}
@@ -0,0 +1,145 @@
+#ifndef UNIQUE_SORT_H
+#define UNIQUE_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "chunk_sort.h"
+#include "sort_buffer.h"
+
+// Sort-unique and sort-with-counts with the duplicates removed inside the
+// merge passes instead of by a scan afterwards. Base chunks are sorted and
+// collapsed to strictly increasing runs; every merge emits one key per step and
+// advances each side whose head equals it, adding up the counts. Runs are
+// written back to back, so the passes after a collapse touch only the keys
+// left: on few-unique data most of the work disappears after the first levels.
+namespace cam {
+
+    namespace uniq {
+
+        struct NoCounts {};
+
+        // Merges the strictly increasing runs a and b into out, collapsing equal
+        // keys; ca, cb and cout are their counts unless C is NoCounts. Returns the end of out.
+        template<class T, class C, class Compare>
+        T* merge(const T* a, const T* ae, const T* b, const T* be, T* out,
+                 const C* ca, const C* cb, C* cout, Compare comp) {
+            constexpr bool counted = !std::is_same_v<C, NoCounts>;
+            while (a < ae && b < be) {
+                CAM_TRACE_LOAD(a);
+                CAM_TRACE_LOAD(b);
+                bool take_a = !comp(*b, *a);  // a <= b
+                bool take_b = !comp(*a, *b);  // b <= a; both when equal
+                *out = take_a ? *a : *b;
+                if constexpr (counted) {
+                    *cout++ = (take_a ? *ca : C(0)) + (take_b ? *cb : C(0));
+                    ca += take_a;
+                    cb += take_b;
+                }
+                out++;
+                a += take_a;
+                b += take_b;
+            }
+            if constexpr (counted) {
+                cout = std::copy(ca, ca + (ae - a), cout);
+                std::copy(cb, cb + (be - b), cout);
+            }
+            out = std::copy(a, ae, out);
+            return std::copy(b, be, out);
+        }
+
+        // Bottom-up sort of v that collapses duplicates; returns the number of unique keys,
+        // which end up at the front of v (counts at the front of counts when counted)
+        template<class Vec, class C, class Compare>
+        size_t sort(Vec& v, C* counts, Compare comp) {
+            using T = typename Vec::value_type;
+            constexpr bool counted = !std::is_same_v<C, NoCounts>;
+            size_t n = v.size();
+            if (n == 0) return 0;
+            size_t chunk = std::max<size_t>(2, CHUNK_SIZE / sizeof(T));
+
+            // Base chunks: sort, then collapse in place; runs become [start[r], start[r + 1])
+            CAM_TRACE_PHASE("unique: base sort");
+            T* a = v.data();
+            std::vector<size_t> start;
+            size_t end = 0;
+            for (size_t i = 0; i < n; i += chunk) {
+                size_t last = std::min(i + chunk, n);
+                std::sort(a + i, a + last, comp);
+                start.push_back(end);
+                a[end] = a[i];
+                if constexpr (counted) counts[end] = 1;
+                for (size_t j = i + 1; j < last; j++) {
+                    if (comp(a[end], a[j])) {
+                        a[++end] = a[j];
+                        if constexpr (counted) counts[end] = 1;
+                    } else if constexpr (counted) {
+                        counts[end]++;
+                    }
+                }
+                end++;
+            }
+            start.push_back(end);
+
+            // Merge passes through scratch of the collapsed size
+            Buffer<T> scratch(end);
+            std::conditional_t<counted, Buffer<C>, std::vector<NoCounts>> scratch_counts(counted ? end : 0);
+            T* src = a;
+            T* dst = scratch.data();
+            C* csrc = counts;
+            C* cdst = scratch_counts.data();
+            auto at = [](C* p, size_t i) {  // Count pointers stay null without counts
+                if constexpr (counted) return p + i;
+                else return p;
+            };
+            while (start.size() > 2) {
+                CAM_TRACE_PHASE("unique: merge pass " + std::to_string(start.size() - 1) + " runs");
+                std::vector<size_t> next{0};
+                T* out = dst;
+                for (size_t r = 0; r + 1 < start.size(); r += 2) {
+                    size_t l = start[r], m = start[r + 1];
+                    size_t e = r + 2 < start.size() ? start[r + 2] : m;
+                    size_t o = out - dst;
+                    out = merge(src + l, src + m, src + m, src + e, out,
+                                at(csrc, l), at(csrc, m), at(cdst, o), comp);
+                    next.push_back(out - dst);
+                }
+                start = std::move(next);
+                std::swap(src, dst);
+                std::swap(csrc, cdst);
+            }
+            size_t unique = start.back();
+            if (src != a) {
+                std::copy(src, src + unique, a);
+                if constexpr (counted) std::copy(csrc, csrc + unique, counts);
+            }
+            return unique;
+        }
+
+    } // namespace uniq
+
+    // Sorts v and removes duplicates in the same passes: v ends up as its
+    // unique keys in ascending order. Returns the number of unique keys.
+    template<class Vec, class Compare = std::less<>>
+    size_t sort_unique(Vec& v, Compare comp = {}) {
+        size_t unique = uniq::sort(v, static_cast<uniq::NoCounts*>(nullptr), comp);
+        v.resize(unique);
+        return unique;
+    }
+
+    // Sorts v into its unique keys and sets counts[i] to the number of occurrences of v[i]
+    template<class Vec, class Counts, class Compare = std::less<>>
+    size_t sort_counts(Vec& v, Counts& counts, Compare comp = {}) {
+        counts.resize(v.size());
+        size_t unique = uniq::sort(v, counts.data(), comp);
+        v.resize(unique);
+        counts.resize(unique);
+        return unique;
+    }
+
+} // namespace cam
+
+#endif // UNIQUE_SORT_H